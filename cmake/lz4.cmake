@@ -0,0 +1,62 @@
+cmake_minimum_required(VERSION 3.11)
+
+add_library(light_lz4 INTERFACE)
+
+# dependency was resolved by conan
+if(TARGET CONAN_PKG::lz4)
+    target_link_libraries(light_lz4 INTERFACE CONAN_PKG::lz4)
+    return()
+endif()
+
+# Try to find lz4 in the cmake search path
+find_package(lz4 QUIET)
+if(lz4_FOUND)
+    if(TARGET LZ4::lz4)
+        target_link_libraries(light_lz4 INTERFACE LZ4::lz4)
+        return()
+    elseif(BUILD_SHARED_LIBS AND TARGET LZ4::lz4_shared)
+        target_link_libraries(light_lz4 INTERFACE LZ4::lz4_shared)
+        return()
+    elseif(TARGET LZ4::lz4_static)
+        target_link_libraries(light_lz4 INTERFACE LZ4::lz4_static)
+        return()
+    endif()
+endif()
+
+# lz4 does not always install a cmake package, try the traditional method, also
+# next to the lz4 tool since package managers like conda put the library there
+find_program(LZ4_PROGRAM lz4)
+if(LZ4_PROGRAM)
+    get_filename_component(LZ4_PREFIX "${LZ4_PROGRAM}" DIRECTORY)
+    get_filename_component(LZ4_PREFIX "${LZ4_PREFIX}" DIRECTORY)
+endif()
+find_path(LZ4_INCLUDE_DIRS lz4frame.h HINTS "${LZ4_PREFIX}/include")
+if(BUILD_SHARED_LIBS)
+    find_library(LZ4_LIB NAMES lz4 liblz4 HINTS "${LZ4_PREFIX}/lib")
+else()
+    find_library(LZ4_LIB NAMES liblz4.a lz4 liblz4 HINTS "${LZ4_PREFIX}/lib")
+endif()
+if(LZ4_INCLUDE_DIRS AND LZ4_LIB)
+    target_link_libraries(light_lz4 INTERFACE "${LZ4_LIB}")
+    target_include_directories(light_lz4 INTERFACE "${LZ4_INCLUDE_DIRS}")
+    return()
+endif()
+
+# compile library if not found
+include(FetchContent)
+
+FetchContent_Declare(
+    lz4
+    GIT_REPOSITORY "https://github.com/lz4/lz4.git"
+    GIT_TAG "v1.9.4"
+    # The cmake project is not at the top level
+    SOURCE_SUBDIR build/cmake
+)
+FetchContent_MakeAvailable(lz4)
+
+if(BUILD_SHARED_LIBS)
+    target_link_libraries(light_lz4 INTERFACE lz4_shared)
+else()
+    target_link_libraries(light_lz4 INTERFACE lz4_static)
+endif()
+target_include_directories(light_lz4 INTERFACE "${lz4_SOURCE_DIR}/lib")
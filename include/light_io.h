@@ -35,7 +35,13 @@ LIGHT_API size_t LIGHT_API_CALL light_io_read(light_file fd, void* buf, size_t c
 LIGHT_API size_t LIGHT_API_CALL light_io_write(light_file fd, const void* buf, size_t count);
 
 LIGHT_API int64_t LIGHT_API_CALL light_io_seek(light_file fd, int64_t offset, int origin);
+// Current position in the (uncompressed) stream, -1 when the backend cannot tell
+LIGHT_API int64_t LIGHT_API_CALL light_io_tell(light_file fd);
 LIGHT_API int LIGHT_API_CALL light_io_flush(light_file fd);
 LIGHT_API int LIGHT_API_CALL light_io_close(light_file fd);
 
+// Builds the random access index that makes seeking in file_name fast, with an access point
+// every span_mb MB (0 for the default). Only gzip files have one: 0 on success, -1 otherwise.
+LIGHT_API int LIGHT_API_CALL light_io_build_index(const char* file_name, uint32_t span_mb);
+
 #endif /* INCLUDE_LIGHT_IO_H_ */
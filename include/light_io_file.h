@@ -22,9 +22,15 @@
 #ifndef INCLUDE_LIGHT_IO_FILE_H_
 #define INCLUDE_LIGHT_IO_FILE_H_
 
+#include "light_export.h"
 #include "light_io.h"
 
 light_file light_io_file_open(const char* filename, const char* mode);
 light_file light_io_file_create(FILE* file);
 
+// Opens filename for reading through a background thread that keeps buffer_count buffers of
+// buffer_size bytes filled ahead of the reader, so disk latency overlaps with parsing.
+// 0 picks the defaults (3 buffers of 8 MB). The file cannot be written.
+LIGHT_API light_file LIGHT_API_CALL light_io_file_open_readahead(const char* filename, size_t buffer_size, uint32_t buffer_count);
+
 #endif /* INCLUDE_LIGHT_IO_FILE_H_ */
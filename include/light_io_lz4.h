@@ -0,0 +1,35 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef INCLUDE_LIGHT_IO_LZ4_H_
+#define INCLUDE_LIGHT_IO_LZ4_H_
+
+#if defined(LIGHT_USE_LZ4)
+
+#include "light_io.h"
+
+// Mode is "r", "w" or "a", optionally followed by a digit 0-9 for the compression level, the
+// fast compressor up to 2 and the much slower high compression one from 3. Written files are
+// LZ4 frames of independent blocks, appending adds a frame that readers go on with.
+light_file light_io_lz4_open(const char* filename, const char* mode);
+
+#endif // LIGHT_USE_LZ4
+
+#endif // INCLUDE_LIGHT_IO_LZ4_H_
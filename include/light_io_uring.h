@@ -0,0 +1,32 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef INCLUDE_LIGHT_IO_URING_H_
+#define INCLUDE_LIGHT_IO_URING_H_
+
+#include "light_export.h"
+#include "light_io.h"
+
+// Opens filename ("rb", "wb" or "ab") with io_uring on Linux. Several large reads or writes are kept
+// in flight, so writers are not blocked by the page cache and readers overlap I/O with parsing.
+// Returns NULL when io_uring is not available, callers are expected to fall back to light_io_open.
+LIGHT_API light_file LIGHT_API_CALL light_io_uring_open(const char* filename, const char* mode);
+
+#endif // INCLUDE_LIGHT_IO_URING_H_
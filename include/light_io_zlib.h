@@ -8,8 +8,16 @@
 
 #include "light_io.h"
 
+// Mode is as for gzopen, optionally followed by ",N": writing or appending then deflates blocks
+// of 1 MB on N workers, each block an independent gzip member of the concatenated file.
+// Reading opens filename.gzidx as well when it was built for this file, seeking then starts
+// inflating from the closest access point instead of the start of the file.
 light_file light_io_zlib_open(const char* filename, const char* mode);
 
+// Writes filename.gzidx with an access point every span_mb MB of uncompressed data, 1 when 0,
+// each keeping the 32 KB window inflating needs to resume there. 0 on success, -1 otherwise.
+int light_io_zlib_build_index(const char* filename, uint32_t span_mb);
+
 #endif // LIGHT_USE_ZLIB
 
 #endif // INCLUDE_LIGHT_IO_ZLIB_H_
\ No newline at end of file
@@ -26,6 +26,12 @@
 
 #include "light_io.h"
 
+// Mode is "r", "w" or "a" (appending may read first, as "a+" does), optionally followed by:
+// a digit 0-9 for the compression level, ",N" for N compression workers and ":N" for frames
+// of N MB, 4 by default. Written files are in the zstd seekable format, frames listed in a
+// seek table at the end that readers use to seek. ":0" writes a single frame without a table.
+// Reading with ",N" decompresses files of several frames on N workers, frames found through
+// the seek table or their headers.
 light_file light_io_zstd_open(const char* filename, const char* mode);
 
 #endif // LIGHT_USE_ZSTD
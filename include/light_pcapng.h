@@ -44,6 +44,7 @@ extern "C" {
 
 // option codes
 
+#define LIGHT_OPTION_END_OF_OPTIONS        0
 #define LIGHT_OPTION_COMMENT               1
 #define LIGHT_OPTION_SHB_HARDWARE          2
 #define LIGHT_OPTION_SHB_OS                3
@@ -75,6 +76,9 @@ extern "C" {
 #define LIGHT_OPTION_EPB_VERDICT           7
 #define LIGHT_OPTION_EPB_PID_TID           8
 
+// well known option codes below this value are resolved by light_index_options
+#define LIGHT_OPTION_INDEX_SIZE            32
+
 #define BYTE_ORDER_MAGIC            0x1A2B3C4D
 
 // error codes
@@ -101,8 +105,34 @@ extern "C" {
 		struct light_option_t* next_option;
 	};
 
+	// Borrowed, unparsed view of a block. Body and options point into memory owned by
+	// the file they were read from and are kept in file byte order.
+	struct light_block_view_t {
+		uint32_t type;
+		uint32_t total_length;
+		const uint8_t* body;
+		uint32_t body_length;
+		const uint8_t* options;
+		uint32_t options_length;
+	};
+
+	// Options of a block view, indexed in one pass without copying them.
+	// Lookups of codes below LIGHT_OPTION_INDEX_SIZE are constant time,
+	// other codes are searched in the raw span when asked for.
+	struct light_option_index_t {
+		const uint8_t* options;
+		uint32_t options_length;
+		bool swap_endianness;
+
+		uint32_t present;
+		const uint8_t* data[LIGHT_OPTION_INDEX_SIZE];
+		uint16_t length[LIGHT_OPTION_INDEX_SIZE];
+	};
+
 	typedef struct light_block_t* light_block;
 	typedef struct light_option_t* light_option;
+	typedef struct light_block_view_t light_block_view;
+	typedef struct light_option_index_t light_option_index;
 
 
 	// endianness fixes
@@ -117,6 +147,22 @@ extern "C" {
 	// The returned record must be freed by either YOU or the next call to light_free_block!
 	LIGHT_API void LIGHT_API_CALL light_read_block(light_file fd, light_block* block, bool *swap_endianess);
 
+	// Read type and total length of the next record, the record itself is not consumed
+	LIGHT_API int LIGHT_API_CALL light_peek_block_header(light_file fd, uint32_t* type, uint32_t* total_length, bool* swap_endianness);
+
+	// Skip next record without reading its body, seeks over it when the file supports seeking
+	LIGHT_API int LIGHT_API_CALL light_skip_block(light_file fd, bool* swap_endianness);
+
+	// First offset at or after offset where a plausible block starts in data: a known block type, the same
+	// total length in header and trailer, followed by another block or the end of data. Returns size if none.
+	// Blocks other than section headers are looked for in the byte order swap_endianness holds,
+	// it is set to the byte order the block was found in.
+	LIGHT_API size_t LIGHT_API_CALL light_find_block(const uint8_t* data, size_t size, size_t offset, bool* swap_endianness);
+
+	// Read next record out of file without copying or parsing it
+	// The view stays valid until the next read from the same file
+	LIGHT_API int LIGHT_API_CALL light_read_block_view(light_file fd, light_block_view* view, bool* swap_endianness);
+
 	LIGHT_API light_block LIGHT_API_CALL light_create_block(uint32_t type, const uint32_t* body, uint32_t body_length);
 
 	LIGHT_API void LIGHT_API_CALL light_free_block(light_block pcapng);
@@ -130,6 +176,11 @@ extern "C" {
 
 	LIGHT_API light_option LIGHT_API_CALL light_find_option(const light_block block, uint16_t option_code);
 
+	// Fills the index from the raw options of the view, the first occurrence of a code wins
+	LIGHT_API void LIGHT_API_CALL light_index_options(light_option_index* index, const light_block_view* view, bool swap_endianness);
+	// Returns the option value and its length, NULL if the block has no such option
+	LIGHT_API const uint8_t* LIGHT_API_CALL light_index_find_option(const light_option_index* index, uint16_t option_code, uint16_t* option_length);
+
 	LIGHT_API int LIGHT_API_CALL light_add_option(light_block section, light_block block, light_option option, bool copy);
 	LIGHT_API int LIGHT_API_CALL light_update_option(light_block section, light_block block, light_option option);
 
@@ -40,6 +40,18 @@ extern "C" {
 struct light_pcapng_t;
 typedef struct light_pcapng_t* light_pcapng;
 
+// reader flags
+
+// Packet comments are owned by the reader and stay valid until the next read,
+// in this mode light_read_packet does not allocate once buffers are warmed up
+#define LIGHT_READ_BORROWED 0x00000001
+
+// Only timestamp_ticks is filled in, the conversion to struct timespec is skipped
+#define LIGHT_READ_RAW_TIMESTAMPS 0x00000002
+
+// No limit on the packet data returned, see light_pcapng_set_snaplen
+#define LIGHT_SNAPLEN_UNLIMITED 0xFFFFFFFF
+
 //different secret types for decryption secret block
 #define LIGHT_DSB_SECRET_TLSK 0x544C534B
 #define LIGHT_DSB_SECRET_WGKL 0x57474B4C
@@ -63,9 +75,45 @@ typedef struct light_packet_header {
 	uint32_t flags;
 	uint64_t dropcount;
 	uint32_t queue;
+	uint32_t comment_length;
+	// Timestamp as stored, in units of the interface timestamp_resolution
+	uint64_t timestamp_ticks;
 
 } light_packet_header;
 
+// Packets of a batch stored as parallel arrays, entry i of every array describes packet i.
+// interface_ids index the interfaces of the whole file, see light_get_interface.
+typedef struct light_packet_batch {
+	size_t capacity;
+	size_t count;
+
+	struct timespec* timestamps;
+	uint64_t* timestamp_ticks;
+	uint32_t* captured_lengths;
+	uint32_t* original_lengths;
+	uint32_t* interface_ids;
+	uint32_t* flags;
+	const uint8_t** packet_data;
+
+} light_packet_batch;
+
+// Packets read are restricted to the ones matching every criteria, checked before the payload is read.
+// Interface ids are global as in light_get_interface, timestamps follow light_packet_header.
+typedef struct light_packet_filter {
+	// Keep packets of these interfaces only, none means every interface
+	const uint32_t* interface_ids;
+	size_t interface_count;
+
+	// Keep packets with start <= timestamp < end, a zero end means no upper bound
+	struct timespec start;
+	struct timespec end;
+
+	// Keep packets with min <= captured length <= max, a zero max means no upper bound
+	uint32_t min_captured_length;
+	uint32_t max_captured_length;
+
+} light_packet_filter;
+
 typedef struct light_packet_decryption {
 	uint32_t secret_type;
 	uint8_t* key;
@@ -97,10 +145,66 @@ LIGHT_API void LIGHT_API_CALL light_free_file_info(light_pcapng_file_info *info)
 
 LIGHT_API light_pcapng_file_info * LIGHT_API_CALL light_pcang_get_file_info(light_pcapng pcapng);
 
+LIGHT_API void LIGHT_API_CALL light_pcapng_set_read_flags(light_pcapng pcapng, uint32_t flags);
+
+// Packet data returned by the following reads is truncated to snaplen bytes like a capture snapshot length,
+// the rest of the payload is skipped in the file. A snaplen of 0 returns packet headers only.
+// captured_length reports the truncated length, original_length is left untouched.
+LIGHT_API void LIGHT_API_CALL light_pcapng_set_snaplen(light_pcapng pcapng, uint32_t snaplen);
+
+// Applies to the following reads, a NULL filter reads every packet again
+LIGHT_API int LIGHT_API_CALL light_pcapng_set_filter(light_pcapng pcapng, const light_packet_filter* filter);
+
 LIGHT_API int LIGHT_API_CALL light_read_packet(light_pcapng pcapng, light_packet_interface* packet_interface, light_packet_header *packet_header, const uint8_t **packet_data);
 
+// After a read failed on a corrupt or truncated block, moves the reader to the next plausible block
+// (see light_find_block) so that reading can go on. Blocks larger than 2 MB may be passed over.
+// Fails when nothing was found up to the end of the file.
+LIGHT_API int LIGHT_API_CALL light_pcapng_resync(light_pcapng pcapng);
+
+LIGHT_API light_packet_batch* LIGHT_API_CALL light_create_packet_batch(size_t capacity);
+LIGHT_API void LIGHT_API_CALL light_free_packet_batch(light_packet_batch* batch);
+
+// Reads up to max packets into the batch, returns the number of packets read (0 at end of file)
+// Packet data stays valid until the next read from the same pcapng
+LIGHT_API int LIGHT_API_CALL light_read_packets(light_pcapng pcapng, light_packet_batch* batch, size_t max);
+
+LIGHT_API int LIGHT_API_CALL light_get_interface(light_pcapng pcapng, uint32_t interface_id, light_packet_interface* packet_interface);
+
+// Packet callback of light_pcapng_read_parallel, a non zero return stops the read and is returned.
+// interface_id is global as in light_get_interface, packet_interface is NULL for packets without interface.
+// Everything passed in is only valid during the call.
+typedef int(*light_packet_callback)(void* context, uint32_t worker, uint32_t interface_id, const light_packet_interface* packet_interface, const light_packet_header* packet_header, const uint8_t* packet_data);
+
+// Callbacks are made from the calling thread in file order, instead of concurrently from the workers
+#define LIGHT_PARALLEL_ORDERED 0x00000001
+
+// Reads an uncompressed capture with several threads (workers 0 means one per CPU), each parsing its own
+// chunk of the file (chunk_size 0 picks one). Packets come out as with light_read_packet, a corrupt block
+// ends the read at the same place. Returns LIGHT_SUCCESS once every packet was delivered.
+LIGHT_API int LIGHT_API_CALL light_pcapng_read_parallel(const char* file_path, uint32_t workers, size_t chunk_size, uint32_t flags, light_packet_callback callback, void* context);
+
+// Writes an index of every block of the capture in one pass, index_path defaults to capture_path + ".lidx"
+LIGHT_API int LIGHT_API_CALL light_pcapng_build_index(const char* capture_path, const char* index_path);
+
+// Attaches an index built with light_pcapng_build_index to a capture opened for reading,
+// fails when the capture no longer has the size it was indexed at
+LIGHT_API int LIGHT_API_CALL light_pcapng_load_index(light_pcapng pcapng, const char* index_path);
+
+// Moves the reader to the first packet at or after timestamp using the loaded index,
+// the capture is expected in timestamp order. Fails when no packet is that late.
+LIGHT_API int LIGHT_API_CALL light_pcapng_seek_time(light_pcapng pcapng, struct timespec timestamp);
+
 LIGHT_API int LIGHT_API_CALL light_write_packet(light_pcapng pcapng, const light_packet_interface* packet_interface, const light_packet_header *packet_header, const uint8_t *packet_data);
 
+// Writes a packet on an interface returned by light_write_interface_block, without looking it up
+LIGHT_API int LIGHT_API_CALL light_write_packet_on(light_pcapng pcapng, int interface_handle, const light_packet_header* packet_header, const uint8_t* packet_data);
+
+// Writes count packets of the same interface, serialized into one region and handed to the file in a single write
+LIGHT_API int LIGHT_API_CALL light_write_packets(light_pcapng pcapng, const light_packet_interface* packet_interface, const light_packet_header* packet_headers, const uint8_t* const* packet_data, size_t count);
+
+// Returns a handle of the new interface for light_write_packet_on, or a negative error code.
+// The handle stays valid until the file is closed.
 LIGHT_API int LIGHT_API_CALL light_write_interface_block(light_pcapng pcapng, const light_packet_interface* packet_interface);
 
 //Writes a decryption secrets Block (DSB) to pcapng file
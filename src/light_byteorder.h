@@ -0,0 +1,114 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef INCLUDE_LIGHT_BYTEORDER_H_
+#define INCLUDE_LIGHT_BYTEORDER_H_
+
+#include "light_pcapng.h"
+
+#include <string.h>
+
+#include "endianness.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LIGHT_BYTEORDER_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define LIGHT_BYTEORDER_NEON 1
+#endif
+
+// Parse routines are written once against these and generated for both byte orders,
+// so the native ones carry no swap and no per-field check
+#define LIGHT_NATIVE16(x) (x)
+#define LIGHT_NATIVE32(x) (x)
+#define LIGHT_NATIVE64(x) (x)
+#define LIGHT_SWAPPED16(x) bswap16(x)
+#define LIGHT_SWAPPED32(x) bswap32(x)
+#define LIGHT_SWAPPED64(x) bswap64(x)
+
+// Swaps four consecutive 32 bit words in place
+static inline void light_bswap32x4(uint32_t* words)
+{
+#if defined(LIGHT_BYTEORDER_SSE2)
+	__m128i v = _mm_loadu_si128((const __m128i*)words);
+	v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xB1), 0xB1);
+	v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+	_mm_storeu_si128((__m128i*)words, v);
+#elif defined(LIGHT_BYTEORDER_NEON)
+	vst1q_u8((uint8_t*)words, vrev32q_u8(vld1q_u8((const uint8_t*)words)));
+#else
+	for (int i = 0; i < 4; i++) {
+		words[i] = bswap32(words[i]);
+	}
+#endif
+}
+
+// Fixed header of an enhanced packet block, body holds at least sizeof(*epb) bytes
+static inline void light_load_epb_native(struct _light_enhanced_packet_block* epb, const uint8_t* body)
+{
+	memcpy(epb, body, sizeof(*epb));
+}
+
+static inline void light_load_epb_swapped(struct _light_enhanced_packet_block* epb, const uint8_t* body)
+{
+	memcpy(epb, body, sizeof(*epb));
+	// Interface, both timestamp halves and captured length in one go
+	light_bswap32x4(&epb->interface_id);
+	epb->original_capture_length = bswap32(epb->original_capture_length);
+}
+
+// Defines light_index_options_<suffix>, the single pass of light_index_options for one byte order
+#define LIGHT_DEFINE_INDEX_OPTIONS(suffix, SWAPPED, SWAP16) \
+static inline void light_index_options_##suffix(light_option_index* index, const light_block_view* view) \
+{ \
+	index->options = view->options; \
+	index->options_length = view->options_length; \
+	index->swap_endianness = SWAPPED; \
+	index->present = 0; \
+\
+	const uint8_t* iterator = view->options; \
+	const uint8_t* end = view->options + view->options_length; \
+\
+	while (end - iterator >= 4) { \
+		uint16_t code, length; \
+		memcpy(&code, iterator, sizeof(code)); \
+		memcpy(&length, iterator + 2, sizeof(length)); \
+		code = SWAP16(code); \
+		length = SWAP16(length); \
+		iterator += 4; \
+		uint32_t actual_length = ((uint32_t)length + 3) & ~3u; \
+		if (code == 0 || actual_length > (size_t)(end - iterator)) { \
+			/* End of options, or the rest is garbage */ \
+			break; \
+		} \
+		if (code < LIGHT_OPTION_INDEX_SIZE && !(index->present & (1u << code))) { \
+			index->present |= 1u << code; \
+			index->data[code] = iterator; \
+			index->length[code] = length; \
+		} \
+		iterator += actual_length; \
+	} \
+}
+
+LIGHT_DEFINE_INDEX_OPTIONS(native, false, LIGHT_NATIVE16)
+LIGHT_DEFINE_INDEX_OPTIONS(swapped, true, LIGHT_SWAPPED16)
+
+#endif /* INCLUDE_LIGHT_BYTEORDER_H_ */
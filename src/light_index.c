@@ -0,0 +1,347 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "light_pcapng_ext.h"
+#include "light_pcapng.h"
+#include "light_debug.h"
+#include "light_internal.h"
+#include "light_io_internal.h"
+#include "light_pcapng_ext_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "endianness.h"
+
+// Index files are a header followed by one entry per block, in file order.
+// They are written in host byte order, an index from another platform is rejected.
+#define LIGHT_INDEX_MAGIC   0x5844494C // LIDX
+#define LIGHT_INDEX_VERSION 2
+#define LIGHT_INDEX_SUFFIX  ".lidx"
+
+#define NSEC_PER_SEC 1000000000ULL
+
+typedef struct light_index_header {
+	uint32_t magic;
+	uint32_t version;
+	// Size of the indexed capture, an index of a capture appended to or rewritten since is rejected
+	uint64_t capture_size;
+	uint64_t count;
+} light_index_header;
+
+typedef struct light_index_entry {
+	uint64_t offset;
+	// Nanoseconds since epoch for packets, other blocks repeat the previous packet
+	uint64_t timestamp;
+	uint32_t type;
+	// Global interface id of packets, as in light_get_interface
+	uint32_t interface_id;
+} light_index_entry;
+
+struct light_index_t {
+	size_t count;
+	light_index_entry* entries;
+
+	// Entries of section headers and interfaces, replayed to restore the interface table
+	size_t context_count;
+	size_t* context;
+};
+
+static uint64_t __timespec_to_ns(struct timespec ts)
+{
+	if (ts.tv_sec < 0) {
+		return 0;
+	}
+	return (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+void light_index_free(struct light_index_t* index)
+{
+	if (index == NULL) {
+		return;
+	}
+	free(index->entries);
+	free(index->context);
+	free(index);
+}
+
+static int __append_entry(light_index_entry** entries, size_t* count, size_t* capacity, const light_index_entry* entry)
+{
+	if (*count == *capacity) {
+		size_t new_capacity = *capacity ? *capacity * 2 : 1024;
+		light_index_entry* new_entries = realloc(*entries, new_capacity * sizeof(light_index_entry));
+		DCHECK_NULLP(new_entries, return LIGHT_OUT_OF_MEMORY);
+		*entries = new_entries;
+		*capacity = new_capacity;
+	}
+	(*entries)[(*count)++] = *entry;
+	return LIGHT_SUCCESS;
+}
+
+static char* __default_index_path(const char* capture_path)
+{
+	size_t length = strlen(capture_path);
+	char* path = malloc(length + sizeof(LIGHT_INDEX_SUFFIX));
+	DCHECK_NULLP(path, return NULL);
+	memcpy(path, capture_path, length);
+	memcpy(path + length, LIGHT_INDEX_SUFFIX, sizeof(LIGHT_INDEX_SUFFIX));
+	return path;
+}
+
+// Size of the capture, -1 when the backend cannot seek to its end and back
+static int64_t __capture_size(light_file file)
+{
+	int64_t offset = light_io_tell(file);
+	if (offset < 0 || light_io_seek(file, 0, SEEK_END) < 0) {
+		return -1;
+	}
+	int64_t size = light_io_tell(file);
+	if (light_io_seek(file, offset, SEEK_SET) < 0) {
+		return -1;
+	}
+	return size;
+}
+
+// One pass over the capture, only headers of packet blocks are read
+static int __index_capture(light_pcapng pcapng, light_index_entry** entries, size_t* count, uint64_t* capture_size)
+{
+	light_file file = pcapng->file;
+	size_t capacity = 0;
+	uint64_t last_timestamp = 0;
+	int64_t size = __capture_size(file);
+	if (size < 0) {
+		return LIGHT_FAILURE;
+	}
+	*capture_size = (uint64_t)size;
+
+	// The section header was consumed when the capture was opened
+	light_index_entry section = { 0, 0, LIGHT_SECTION_HEADER_BLOCK, 0 };
+	int res = __append_entry(entries, count, &capacity, &section);
+
+	while (res == LIGHT_SUCCESS)
+	{
+		int64_t offset = light_io_tell(file);
+		uint32_t type, length;
+		if (offset < 0) {
+			return LIGHT_FAILURE;
+		}
+		if (light_peek_block_header(file, &type, &length, &pcapng->swap_endianness) != LIGHT_SUCCESS) {
+			// End of file only when nothing was left to read, a bad or partial header is corruption
+			if (light_io_tell(file) != offset) {
+				return LIGHT_FAILURE;
+			}
+			break;
+		}
+		// Seeking over a truncated last block would not notice it
+		if (offset + (int64_t)length > size) {
+			return LIGHT_FAILURE;
+		}
+
+		light_index_entry entry = { (uint64_t)offset, last_timestamp, type, 0 };
+
+		if (type == LIGHT_SECTION_HEADER_BLOCK || type == LIGHT_INTERFACE_BLOCK) {
+			light_block_view view;
+			res = light_read_block_view(file, &view, &pcapng->swap_endianness);
+			if (res == LIGHT_SUCCESS) {
+				res = light_pcapng_track_block(pcapng, &view);
+			}
+		}
+		else {
+			if (type == LIGHT_ENHANCED_PACKET_BLOCK) {
+				struct _light_enhanced_packet_block epb = { 0 };
+				const uint8_t* body;
+				uint32_t available;
+				res = light_peek_block_body(file, sizeof(epb), &body, &available, &pcapng->swap_endianness);
+				if (res == LIGHT_SUCCESS && available >= sizeof(epb)) {
+					memcpy(&epb, body, sizeof(epb));
+				}
+				fix_endianness_enhanced_packet_block(&epb, pcapng->swap_endianness);
+
+				entry.interface_id = pcapng->section_interface_offset + epb.interface_id;
+				uint64_t timestamp = ((uint64_t)epb.timestamp_high << 32) + epb.timestamp_low;
+				entry.timestamp = __timespec_to_ns(light_pcapng_timestamp(pcapng, entry.interface_id, timestamp));
+				last_timestamp = entry.timestamp;
+			}
+			if (type == LIGHT_SIMPLE_PACKET_BLOCK) {
+				entry.interface_id = pcapng->section_interface_offset;
+			}
+			if (res == LIGHT_SUCCESS) {
+				res = light_skip_block(file, &pcapng->swap_endianness);
+			}
+		}
+
+		if (res == LIGHT_SUCCESS) {
+			res = __append_entry(entries, count, &capacity, &entry);
+		}
+	}
+
+	return res;
+}
+
+int light_pcapng_build_index(const char* capture_path, const char* index_path)
+{
+	DCHECK_NULLP(capture_path, return LIGHT_INVALID_ARGUMENT);
+
+	light_pcapng pcapng = light_pcapng_open(capture_path, "rb");
+	if (pcapng == NULL) {
+		return LIGHT_FAILURE;
+	}
+	if (pcapng->file_info == NULL) {
+		// Not even a section header
+		light_pcapng_close(pcapng);
+		return LIGHT_FAILURE;
+	}
+
+	light_index_entry* entries = NULL;
+	size_t count = 0;
+	uint64_t capture_size = 0;
+	int res = __index_capture(pcapng, &entries, &count, &capture_size);
+	light_pcapng_close(pcapng);
+
+	char* default_path = NULL;
+	if (res == LIGHT_SUCCESS && index_path == NULL) {
+		default_path = __default_index_path(capture_path);
+		index_path = default_path;
+		if (index_path == NULL) {
+			res = LIGHT_OUT_OF_MEMORY;
+		}
+	}
+
+	if (res == LIGHT_SUCCESS) {
+		light_file file = light_io_open(index_path, "wb");
+		light_index_header header = { LIGHT_INDEX_MAGIC, LIGHT_INDEX_VERSION, capture_size, count };
+		if (file == NULL
+			|| light_io_write(file, &header, sizeof(header)) != sizeof(header)
+			|| light_io_write(file, entries, count * sizeof(light_index_entry)) != count * sizeof(light_index_entry)) {
+			res = LIGHT_FAILURE;
+		}
+		if (file != NULL && light_io_close(file) != 0) {
+			res = LIGHT_FAILURE;
+		}
+	}
+
+	free(default_path);
+	free(entries);
+	return res;
+}
+
+int light_pcapng_load_index(light_pcapng pcapng, const char* index_path)
+{
+	DCHECK_NULLP(pcapng, return LIGHT_INVALID_ARGUMENT);
+	DCHECK_NULLP(index_path, return LIGHT_INVALID_ARGUMENT);
+
+	int64_t capture_size = __capture_size(pcapng->file);
+	if (capture_size < 0) {
+		return LIGHT_FAILURE;
+	}
+
+	light_file file = light_io_open(index_path, "rb");
+	if (file == NULL) {
+		return LIGHT_FAILURE;
+	}
+
+	light_index_header header = { 0 };
+	if (light_io_read(file, &header, sizeof(header)) != sizeof(header)
+		|| header.magic != LIGHT_INDEX_MAGIC
+		|| header.version != LIGHT_INDEX_VERSION
+		|| header.capture_size != (uint64_t)capture_size
+		|| header.count > SIZE_MAX / sizeof(light_index_entry)) {
+		light_io_close(file);
+		return LIGHT_FAILURE;
+	}
+
+	struct light_index_t* index = calloc(1, sizeof(struct light_index_t));
+	DCHECK_NULLP(index, { light_io_close(file); return LIGHT_OUT_OF_MEMORY; });
+	index->count = (size_t)header.count;
+	index->entries = malloc(index->count * sizeof(light_index_entry) + 1);
+	index->context = malloc(index->count * sizeof(size_t) + 1);
+	if (index->entries == NULL || index->context == NULL) {
+		light_index_free(index);
+		light_io_close(file);
+		return LIGHT_OUT_OF_MEMORY;
+	}
+
+	size_t bytes = index->count * sizeof(light_index_entry);
+	bool complete = light_io_read(file, index->entries, bytes) == bytes;
+	light_io_close(file);
+	if (!complete) {
+		light_index_free(index);
+		return LIGHT_FAILURE;
+	}
+
+	for (size_t i = 0; i < index->count; i++) {
+		uint32_t type = index->entries[i].type;
+		if (type == LIGHT_SECTION_HEADER_BLOCK || type == LIGHT_INTERFACE_BLOCK) {
+			index->context[index->context_count++] = i;
+		}
+	}
+
+	light_index_free(pcapng->index);
+	pcapng->index = index;
+	return LIGHT_SUCCESS;
+}
+
+int light_pcapng_seek_time(light_pcapng pcapng, struct timespec timestamp)
+{
+	DCHECK_NULLP(pcapng, return LIGHT_INVALID_ARGUMENT);
+	DCHECK_NULLP(pcapng->index, return LIGHT_INVALID_ARGUMENT);
+
+	const struct light_index_t* index = pcapng->index;
+	uint64_t target = __timespec_to_ns(timestamp);
+
+	// First entry at or after the timestamp, then the first packet from there
+	size_t low = 0;
+	size_t high = index->count;
+	while (low < high) {
+		size_t mid = low + (high - low) / 2;
+		if (index->entries[mid].timestamp < target) {
+			low = mid + 1;
+		}
+		else {
+			high = mid;
+		}
+	}
+	while (low < index->count
+		&& index->entries[low].type != LIGHT_ENHANCED_PACKET_BLOCK
+		&& index->entries[low].type != LIGHT_SIMPLE_PACKET_BLOCK) {
+		low++;
+	}
+	if (low == index->count) {
+		return LIGHT_FAILURE;
+	}
+
+	// Rebuild the interface table as it stands at that packet
+	light_pcapng_clear_interfaces(pcapng);
+	for (size_t i = 0; i < index->context_count && index->context[i] < low; i++) {
+		light_block_view view;
+		if (light_io_seek(pcapng->file, (int64_t)index->entries[index->context[i]].offset, SEEK_SET) < 0
+			|| light_read_block_view(pcapng->file, &view, &pcapng->swap_endianness) != LIGHT_SUCCESS
+			|| light_pcapng_track_block(pcapng, &view) != LIGHT_SUCCESS) {
+			return LIGHT_FAILURE;
+		}
+	}
+
+	if (light_io_seek(pcapng->file, (int64_t)index->entries[low].offset, SEEK_SET) < 0) {
+		return LIGHT_FAILURE;
+	}
+
+	return LIGHT_SUCCESS;
+}
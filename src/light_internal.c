@@ -32,32 +32,34 @@ uint16_t __get_option_total_size(const light_option option)
 	light_option iter = option;
 	while (iter != NULL) {
 		uint16_t actual_length;
-		PADD32(option->length, &actual_length);
+		PADD32(iter->length, &actual_length);
 		size += 4 + actual_length;
-		iter = option->next_option;
+		iter = iter->next_option;
 	}
 	return size;
 }
 
 light_option __copy_option(const light_option option)
 {
-	if (option == NULL) {
-		return NULL;
-	}
+	light_option first = NULL;
+	light_option* next = &first;
 
-	size_t current_size = 0;
-	light_option copy = calloc(1, sizeof(struct light_option_t));
+	for (light_option iter = option; iter != NULL; iter = iter->next_option) {
+		size_t current_size = 0;
+		light_option copy = calloc(1, sizeof(struct light_option_t));
 
-	PADD32(option->length, &current_size);
+		PADD32(iter->length, &current_size);
 
-	copy->code = option->code;
-	copy->length = option->length;
-	copy->data = calloc(1, current_size);
-	memcpy(copy->data, option->data, option->length);
+		copy->code = iter->code;
+		copy->length = iter->length;
+		copy->data = calloc(1, current_size);
+		memcpy(copy->data, iter->data, iter->length);
 
-	copy->next_option = __copy_option(option->next_option);
+		*next = copy;
+		next = &copy->next_option;
+	}
 
-	return copy;
+	return first;
 }
 
 bool __is_section_header(const light_block section)
@@ -0,0 +1,50 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef INCLUDE_LIGHT_INTERNAL_H_
+#define INCLUDE_LIGHT_INTERNAL_H_
+
+#include "light_pcapng.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Parses a borrowed block view into a heap allocated block, NULL on failure
+light_block light_block_from_view(const light_block_view* view, const bool swap_endianness);
+
+// Returns the first option with the given code out of a raw options span, NULL if not found
+const uint8_t* light_find_option_view(const uint8_t* options, uint32_t options_length, uint16_t option_code, uint16_t* option_length, const bool swap_endianness);
+
+// Makes the first count bytes of the pending block body available without consuming the block,
+// they stay valid until the block is read or skipped. Section headers cannot be peeked into.
+int light_peek_block_body(light_file fd, uint32_t count, const uint8_t** body, uint32_t* available, bool* swap_endianness);
+
+// Reads the pending block like light_read_block_view, but packet blocks keep at most max_data bytes of
+// packet data, the rest is skipped. The view body then holds the fixed header, the kept data and the options.
+int light_read_block_view_truncated(light_file fd, uint32_t max_data, light_block_view* view, bool* swap_endianness);
+
+// Checks the block at offset the way light_read_block_view would, a section header sets the byte order
+bool light_check_block(const uint8_t* data, size_t size, size_t offset, bool* swap_endianness, uint32_t* type, uint32_t* length);
+
+// Same as light_find_block, only blocks starting before limit at a multiple of step (1 or 4) are considered
+size_t light_find_block_range(const uint8_t* data, size_t size, size_t offset, size_t limit, size_t step, bool* swap_endianness);
+
+#endif /* INCLUDE_LIGHT_INTERNAL_H_ */
@@ -24,6 +24,7 @@
 #include "light_io_file.h"
 #include "light_io_zstd.h"
 #include "light_io_zlib.h"
+#include "light_io_lz4.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -48,7 +49,7 @@ light_file light_io_open(const char* filename, const char* mode)
 	if (!filename) {
 		return NULL;
 	}
-#if defined(LIGHT_USE_ZSTD) || defined(LIGHT_USE_ZLIB)
+#if defined(LIGHT_USE_ZSTD) || defined(LIGHT_USE_ZLIB) || defined(LIGHT_USE_LZ4)
 	const char* ext = get_filename_ext(filename);
 #endif
 
@@ -64,15 +65,56 @@ light_file light_io_open(const char* filename, const char* mode)
 	}
 #endif
 
+#if defined(LIGHT_USE_LZ4)
+	if (strcasecmp(ext, ".lz4") == 0) {
+		return light_io_lz4_open(filename, mode);
+	}
+#endif
+
 	return light_io_file_open(filename, mode);
 }
 
+int light_io_build_index(const char* filename, uint32_t span_mb)
+{
+	if (!filename) {
+		return -1;
+	}
+#if defined(LIGHT_USE_ZLIB)
+	if (strcasecmp(get_filename_ext(filename), ".gz") == 0) {
+		return light_io_zlib_build_index(filename, span_mb);
+	}
+#endif
+	(void)span_mb;
+	return -1;
+}
+
+static void __advance(light_file fd, size_t count)
+{
+	if (fd->position >= 0) {
+		fd->position += (int64_t)count;
+	}
+}
+
 size_t light_io_read(light_file fd, void* buf, size_t count)
 {
+	size_t done = 0;
+	if (fd->unread_offset < fd->unread_size) {
+		size_t pending = fd->unread_size - fd->unread_offset;
+		done = count < pending ? count : pending;
+		memcpy(buf, fd->unread + fd->unread_offset, done);
+		fd->unread_offset += done;
+		if (done == count) {
+			__advance(fd, done);
+			return done;
+		}
+	}
 	if (fd->fn_read == NULL) {
-		return 0;
+		__advance(fd, done);
+		return done;
 	}
-	return fd->fn_read(fd->context, buf, count);
+	done += fd->fn_read(fd->context, (uint8_t*)buf + done, count - done);
+	__advance(fd, done);
+	return done;
 }
 
 size_t light_io_write(light_file fd, const void* buf, size_t count)
@@ -80,7 +122,43 @@ size_t light_io_write(light_file fd, const void* buf, size_t count)
 	if (fd->fn_write == NULL) {
 		return 0;
 	}
-	return fd->fn_write(fd->context, buf, count);
+	size_t done = fd->fn_write(fd->context, buf, count);
+	__advance(fd, done);
+	return done;
+}
+
+const uint8_t* light_io_borrow(light_file fd, size_t count)
+{
+	// Unread bytes are not in the backend memory, go through a copy
+	if (fd->fn_borrow == NULL || fd->unread_offset < fd->unread_size) {
+		return NULL;
+	}
+	const uint8_t* data = fd->fn_borrow(fd->context, count);
+	if (data != NULL) {
+		__advance(fd, count);
+	}
+	return data;
+}
+
+int light_io_unread(light_file fd, const void* data, size_t count)
+{
+	size_t pending = fd->unread_size - fd->unread_offset;
+	uint8_t* unread = malloc(count + pending + 1);
+	if (unread == NULL) {
+		return -1;
+	}
+	memcpy(unread, data, count);
+	if (pending > 0) {
+		memcpy(unread + count, fd->unread + fd->unread_offset, pending);
+	}
+	free(fd->unread);
+	fd->unread = unread;
+	fd->unread_size = count + pending;
+	fd->unread_offset = 0;
+	if (fd->position >= 0) {
+		fd->position = fd->position >= (int64_t)count ? fd->position - (int64_t)count : -1;
+	}
+	return 0;
 }
 
 int64_t light_io_seek(light_file fd, int64_t offset, int origin)
@@ -88,7 +166,45 @@ int64_t light_io_seek(light_file fd, int64_t offset, int origin)
 	if (fd->fn_seek == NULL) {
 		return -1;
 	}
-	return fd->fn_seek(fd->context, offset, origin);
+	// A peeked block header does not describe the new position
+	fd->peeked = false;
+	fd->peeked_body_length = 0;
+
+	// The backend is ahead of us by whatever was unread
+	size_t pending = fd->unread_size - fd->unread_offset;
+	if (origin == SEEK_CUR) {
+		offset -= (int64_t)pending;
+	}
+	int64_t res = fd->fn_seek(fd->context, offset, origin);
+	if (res < 0) {
+		return res;
+	}
+	fd->unread_offset = fd->unread_size;
+
+	switch (origin)
+	{
+	case SEEK_SET:
+		fd->position = offset;
+		break;
+	case SEEK_CUR:
+		if (fd->position >= 0) {
+			fd->position += offset + (int64_t)pending;
+		}
+		break;
+	default:
+		fd->position = fd->fn_tell ? fd->fn_tell(fd->context) : -1;
+		break;
+	}
+	return res;
+}
+
+int64_t light_io_tell(light_file fd)
+{
+	if (fd->fn_tell == NULL) {
+		return -1;
+	}
+	int64_t res = fd->fn_tell(fd->context);
+	return res < 0 ? res : res - (int64_t)(fd->unread_size - fd->unread_offset);
 }
 
 int light_io_flush(light_file fd)
@@ -105,6 +221,40 @@ int light_io_close(light_file fd)
 		return 0;
 	}
 	int res = fd->fn_close(fd->context);
+	free(fd->buffer);
+	free(fd->unread);
 	free(fd);
 	return res;
 }
+
+uint8_t* light_io_reserve(light_file fd, size_t size)
+{
+	if (size > fd->buffer_size) {
+		// Old content is not needed, avoid the copy realloc would do
+		free(fd->buffer);
+		fd->buffer = malloc(size);
+		fd->buffer_size = fd->buffer ? size : 0;
+	}
+	return fd->buffer;
+}
+
+uint8_t* light_io_grow(light_file fd, size_t size, size_t keep)
+{
+	if (size > fd->buffer_size) {
+		uint8_t* buffer = malloc(size);
+		if (buffer != NULL && keep > 0) {
+			memcpy(buffer, fd->buffer, keep);
+		}
+		free(fd->buffer);
+		fd->buffer = buffer;
+		fd->buffer_size = buffer ? size : 0;
+	}
+	return fd->buffer;
+}
+
+bool light_io_in_buffer(light_file fd, const void* data)
+{
+	uintptr_t ptr = (uintptr_t)data;
+	uintptr_t start = (uintptr_t)fd->buffer;
+	return fd->buffer != NULL && ptr >= start && ptr < start + fd->buffer_size;
+}
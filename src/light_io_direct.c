@@ -0,0 +1,244 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+// O_DIRECT and fallocate
+#define _GNU_SOURCE
+#endif
+
+#include "light_io_direct.h"
+#include "light_io_internal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(__linux__)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Direct I/O wants buffers, offsets and lengths aligned to the logical block size, 4 KB covers every common device
+#define DIRECT_ALIGNMENT 4096
+#define DIRECT_BUFFER_SIZE (4 * 1024 * 1024)
+// Extents are reserved this far ahead of the data
+#define DIRECT_PREALLOCATE_STEP (64 * 1024 * 1024)
+
+typedef struct direct_context {
+	int fd;
+	bool direct;
+	bool preallocate;
+	bool failed;
+
+	uint8_t* buffer;
+	size_t used;
+	// File offset of the buffer start, always aligned
+	int64_t buffer_offset;
+	// File is allocated up to here
+	int64_t allocated;
+} direct_context;
+
+static size_t __align_up(size_t value)
+{
+	return (value + DIRECT_ALIGNMENT - 1) & ~(size_t)(DIRECT_ALIGNMENT - 1);
+}
+
+static int __reserve(direct_context* direct, int64_t end)
+{
+	if (!direct->preallocate || end <= direct->allocated) {
+		return 0;
+	}
+	int64_t length = end - direct->allocated;
+	length = (length + DIRECT_PREALLOCATE_STEP - 1) / DIRECT_PREALLOCATE_STEP * DIRECT_PREALLOCATE_STEP;
+	// Beyond the end of the file, readers of a live capture do not see the reserved extents
+	if (fallocate(direct->fd, FALLOC_FL_KEEP_SIZE, direct->allocated, length) != 0) {
+		// Not supported by the file system, writing goes on without it
+		direct->preallocate = false;
+		return 0;
+	}
+	direct->allocated += length;
+	return 0;
+}
+
+// Writes the buffer out, a partial last block is padded and kept in the buffer to be completed later
+static int __write_buffer(direct_context* direct)
+{
+	size_t length = __align_up(direct->used);
+	if (length == 0) {
+		return 0;
+	}
+	memset(direct->buffer + direct->used, 0, length - direct->used);
+	__reserve(direct, direct->buffer_offset + (int64_t)length);
+
+	size_t done = 0;
+	while (done < length) {
+		ssize_t res = pwrite(direct->fd, direct->buffer + done, length - done, direct->buffer_offset + (int64_t)done);
+		if (res < 0 && errno == EINTR) {
+			continue;
+		}
+		if (res <= 0) {
+			direct->failed = true;
+			return -1;
+		}
+		done += (size_t)res;
+	}
+	if (!direct->direct) {
+		// Without O_DIRECT at least tell the kernel we will not read this back
+		posix_fadvise(direct->fd, direct->buffer_offset, (off_t)length, POSIX_FADV_DONTNEED);
+	}
+
+	size_t keep = direct->used % DIRECT_ALIGNMENT;
+	size_t written = direct->used - keep;
+	memmove(direct->buffer, direct->buffer + written, keep);
+	direct->buffer_offset += (int64_t)written;
+	direct->used = keep;
+	return 0;
+}
+
+static size_t light_direct_write(void* context, const void* buf, size_t count)
+{
+	direct_context* direct = context;
+	size_t done = 0;
+	while (done < count && !direct->failed) {
+		size_t space = DIRECT_BUFFER_SIZE - direct->used;
+		size_t chunk = count - done < space ? count - done : space;
+		memcpy(direct->buffer + direct->used, (const uint8_t*)buf + done, chunk);
+		direct->used += chunk;
+		if (direct->used == DIRECT_BUFFER_SIZE && __write_buffer(direct) != 0) {
+			// Never reached the file, the caller sees a short write
+			direct->used -= chunk;
+			break;
+		}
+		done += chunk;
+	}
+	return done;
+}
+
+static int64_t light_direct_tell(void* context)
+{
+	direct_context* direct = context;
+	return direct->buffer_offset + (int64_t)direct->used;
+}
+
+// Cuts the file down to what was written, padding and preallocated extents go
+static int __trim(direct_context* direct)
+{
+	int64_t size = direct->buffer_offset + (int64_t)direct->used;
+	if (ftruncate(direct->fd, size) != 0) {
+		return -1;
+	}
+	direct->allocated = size;
+	return 0;
+}
+
+static int light_direct_flush(void* context)
+{
+	direct_context* direct = context;
+	// The preallocated extents stay, flushing often must not give them back
+	if (direct->failed || __write_buffer(direct) != 0) {
+		return -1;
+	}
+	return 0;
+}
+
+static int light_direct_close(void* context)
+{
+	direct_context* direct = context;
+	int res = light_direct_flush(direct);
+	if (res == 0) {
+		res = __trim(direct);
+	}
+	res |= close(direct->fd);
+	free(direct->buffer);
+	free(direct);
+	return res;
+}
+
+light_file light_io_direct_open(const char* filename, const char* mode)
+{
+	if (!filename || !mode || strchr(mode, '+') != NULL) {
+		return NULL;
+	}
+	bool append = strchr(mode, 'a') != NULL;
+	if (!append && strchr(mode, 'w') == NULL) {
+		return NULL;
+	}
+	int flags = O_RDWR | O_CREAT | O_CLOEXEC | (append ? 0 : O_TRUNC);
+
+	direct_context* direct = calloc(1, sizeof(direct_context));
+	if (direct == NULL) {
+		return NULL;
+	}
+	if (posix_memalign((void**)&direct->buffer, DIRECT_ALIGNMENT, DIRECT_BUFFER_SIZE) != 0) {
+		free(direct);
+		return NULL;
+	}
+	direct->direct = true;
+	direct->preallocate = true;
+	direct->fd = open(filename, flags | O_DIRECT, 0666);
+	if (direct->fd < 0 && errno == EINVAL) {
+		// The file system does not do direct I/O (tmpfs for one), write through the cache instead
+		direct->direct = false;
+		direct->fd = open(filename, flags, 0666);
+	}
+	if (direct->fd < 0) {
+		free(direct->buffer);
+		free(direct);
+		return NULL;
+	}
+
+	struct stat info;
+	if (append && fstat(direct->fd, &info) == 0 && info.st_size > 0) {
+		// Continue from the last aligned block, its start is read back into the buffer
+		direct->allocated = info.st_size;
+		direct->buffer_offset = info.st_size & ~(int64_t)(DIRECT_ALIGNMENT - 1);
+		direct->used = (size_t)(info.st_size - direct->buffer_offset);
+		if (direct->used > 0 && pread(direct->fd, direct->buffer, DIRECT_ALIGNMENT, direct->buffer_offset) < (ssize_t)direct->used) {
+			close(direct->fd);
+			free(direct->buffer);
+			free(direct);
+			return NULL;
+		}
+	}
+
+	light_file fd = calloc(1, sizeof(struct light_file_t));
+	fd->context = direct;
+	fd->fn_write = &light_direct_write;
+	fd->fn_tell = &light_direct_tell;
+	fd->fn_flush = &light_direct_flush;
+	fd->fn_close = &light_direct_close;
+	fd->position = light_direct_tell(direct);
+	return fd;
+}
+
+#else
+
+light_file light_io_direct_open(const char* filename, const char* mode)
+{
+	(void)filename;
+	(void)mode;
+	return NULL;
+}
+
+#endif
@@ -21,8 +21,17 @@
 
 #include "light_io_file.h"
 #include "light_io_internal.h"
+#include "light_thread.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+// Read-ahead defaults, big enough to keep a disk streaming while the previous buffer is parsed
+#define READAHEAD_BUFFER_SIZE (8 * 1024 * 1024)
+#define READAHEAD_BUFFER_COUNT 3
+// Buffers start on a page, which keeps the kernel copying whole pages into them
+#define READAHEAD_ALIGNMENT 4096
 
 static size_t light_file_read(void* context, void* buf, size_t count)
 {
@@ -36,9 +45,8 @@ static size_t light_file_write(void* context, const void* buf, size_t count)
 	return fwrite(buf, 1, count, file);
 }
 
-static int64_t light_file_seek(void* context, int64_t offset, int origin)
+static int64_t __file_seek(FILE* file, int64_t offset, int origin)
 {
-	FILE* file = context;
 #if _WIN32
 	return _fseeki64(file, offset, origin);
 #elif (HAVE_FSEEKO64 + 0)
@@ -48,6 +56,27 @@ static int64_t light_file_seek(void* context, int64_t offset, int origin)
 #endif
 }
 
+static int64_t __file_tell(FILE* file)
+{
+#if _WIN32
+	return _ftelli64(file);
+#elif (HAVE_FSEEKO64 + 0)
+	return ftello64(file);
+#else
+	return ftell(file);
+#endif
+}
+
+static int64_t light_file_seek(void* context, int64_t offset, int origin)
+{
+	return __file_seek(context, offset, origin);
+}
+
+static int64_t light_file_tell(void* context)
+{
+	return __file_tell(context);
+}
+
 int light_file_flush(void* context)
 {
 	FILE* file = context;
@@ -77,7 +106,262 @@ light_file light_io_file_create(FILE* file)
 	fd->fn_read = &light_file_read;
 	fd->fn_write = &light_file_write;
 	fd->fn_seek = &light_file_seek;
+	fd->fn_tell = &light_file_tell;
 	fd->fn_flush = &light_file_flush;
 	fd->fn_close = &light_file_close;
 	return fd;
 }
+
+typedef struct readahead_buffer {
+	uint8_t* data;
+	size_t size;
+} readahead_buffer;
+
+typedef struct file_readahead_t {
+	FILE* file;
+	light_thread thread;
+	light_mutex mutex;
+	light_cond cond;
+
+	// Ring of buffers, filled by the thread from head onwards
+	readahead_buffer* buffers;
+	uint32_t buffer_count;
+	size_t buffer_size;
+	uint32_t head;
+	uint32_t filled;
+	bool eof;
+	bool stop;
+
+	// The reader owns the head buffer while it copies out of it
+	size_t consumed;
+	int64_t position;
+} file_readahead_t;
+
+static void __readahead_main(void* arg)
+{
+	file_readahead_t* readahead = arg;
+	light_mutex_lock(&readahead->mutex);
+	while (!readahead->stop && !readahead->eof) {
+		if (readahead->filled == readahead->buffer_count) {
+			light_cond_wait(&readahead->cond, &readahead->mutex);
+			continue;
+		}
+		// The slot behind the filled ones is neither read nor written by anyone else
+		readahead_buffer* buffer = &readahead->buffers[(readahead->head + readahead->filled) % readahead->buffer_count];
+		light_mutex_unlock(&readahead->mutex);
+
+		size_t size = fread(buffer->data, 1, readahead->buffer_size, readahead->file);
+
+		light_mutex_lock(&readahead->mutex);
+		buffer->size = size;
+		if (size > 0) {
+			readahead->filled++;
+		}
+		if (size < readahead->buffer_size) {
+			readahead->eof = true;
+		}
+		light_cond_broadcast(&readahead->cond);
+	}
+	light_mutex_unlock(&readahead->mutex);
+}
+
+static int __readahead_start(file_readahead_t* readahead)
+{
+	readahead->head = 0;
+	readahead->filled = 0;
+	readahead->consumed = 0;
+	readahead->eof = false;
+	readahead->stop = false;
+	return light_thread_create(&readahead->thread, __readahead_main, readahead);
+}
+
+static void __readahead_stop(file_readahead_t* readahead)
+{
+	light_mutex_lock(&readahead->mutex);
+	readahead->stop = true;
+	light_cond_broadcast(&readahead->cond);
+	light_mutex_unlock(&readahead->mutex);
+	light_thread_join(readahead->thread);
+}
+
+static void* __aligned_alloc(size_t size)
+{
+#if _WIN32
+	return _aligned_malloc(size, READAHEAD_ALIGNMENT);
+#else
+	void* data = NULL;
+	return posix_memalign(&data, READAHEAD_ALIGNMENT, size) == 0 ? data : NULL;
+#endif
+}
+
+static void __aligned_free(void* data)
+{
+#if _WIN32
+	_aligned_free(data);
+#else
+	free(data);
+#endif
+}
+
+// Copies count bytes out of the ring into buf, or only steps over them when buf is NULL
+static size_t __readahead_consume(file_readahead_t* readahead, uint8_t* buf, size_t count)
+{
+	size_t done = 0;
+	while (done < count) {
+		light_mutex_lock(&readahead->mutex);
+		while (readahead->filled == 0 && !readahead->eof) {
+			light_cond_wait(&readahead->cond, &readahead->mutex);
+		}
+		bool empty = readahead->filled == 0;
+		light_mutex_unlock(&readahead->mutex);
+		if (empty) {
+			break;
+		}
+
+		readahead_buffer* buffer = &readahead->buffers[readahead->head];
+		size_t available = buffer->size - readahead->consumed;
+		size_t chunk = count - done < available ? count - done : available;
+		if (buf != NULL) {
+			memcpy(buf + done, buffer->data + readahead->consumed, chunk);
+		}
+		readahead->consumed += chunk;
+		done += chunk;
+
+		// Hand the buffer back to the thread
+		if (readahead->consumed == buffer->size) {
+			light_mutex_lock(&readahead->mutex);
+			readahead->head = (readahead->head + 1) % readahead->buffer_count;
+			readahead->filled--;
+			readahead->consumed = 0;
+			light_cond_broadcast(&readahead->cond);
+			light_mutex_unlock(&readahead->mutex);
+		}
+	}
+	readahead->position += (int64_t)done;
+	return done;
+}
+
+static size_t light_readahead_read(void* context, void* buf, size_t count)
+{
+	return __readahead_consume(context, buf, count);
+}
+
+static int64_t light_readahead_seek(void* context, int64_t offset, int origin)
+{
+	file_readahead_t* readahead = context;
+
+	// The file is ahead of the reader by everything buffered
+	if (origin == SEEK_CUR) {
+		offset += readahead->position;
+		origin = SEEK_SET;
+	}
+
+	// Forwards within the ring, buffers filled or being filled: step over the data and keep
+	// the thread going, skipping a packet must not throw away what was read ahead
+	int64_t window = (int64_t)(readahead->buffer_count * readahead->buffer_size - readahead->consumed);
+	if (origin == SEEK_SET && !readahead->stop && offset >= readahead->position && offset - readahead->position <= window) {
+		size_t distance = (size_t)(offset - readahead->position);
+		if (__readahead_consume(readahead, NULL, distance) < distance) {
+			// Past the end of the file, as fseek allows, reads there see the end
+			readahead->position = offset;
+		}
+		return 0;
+	}
+
+	__readahead_stop(readahead);
+	int64_t res = __file_seek(readahead->file, offset, origin);
+	if (res == 0) {
+		readahead->position = __file_tell(readahead->file);
+	}
+	else {
+		__file_seek(readahead->file, readahead->position, SEEK_SET);
+	}
+
+	if (__readahead_start(readahead) != 0) {
+		// Without the thread no more data comes in, reads see the end of the file
+		readahead->eof = true;
+		readahead->stop = true;
+		return -1;
+	}
+	return res;
+}
+
+static int64_t light_readahead_tell(void* context)
+{
+	file_readahead_t* readahead = context;
+	return readahead->position;
+}
+
+static void __readahead_free(file_readahead_t* readahead)
+{
+	for (uint32_t i = 0; i < readahead->buffer_count; i++) {
+		__aligned_free(readahead->buffers[i].data);
+	}
+	free(readahead->buffers);
+	light_cond_destroy(&readahead->cond);
+	light_mutex_destroy(&readahead->mutex);
+	free(readahead);
+}
+
+static int light_readahead_close(void* context)
+{
+	file_readahead_t* readahead = context;
+	if (!readahead->stop) {
+		__readahead_stop(readahead);
+	}
+	int res = fclose(readahead->file);
+	__readahead_free(readahead);
+	return res;
+}
+
+light_file light_io_file_open_readahead(const char* filename, size_t buffer_size, uint32_t buffer_count)
+{
+	if (!filename) {
+		return NULL;
+	}
+	FILE* file = fopen(filename, "rb");
+	if (!file) {
+		return NULL;
+	}
+	// The reader keeps one buffer, the thread needs at least another one to fill
+	buffer_size = buffer_size > 0 ? buffer_size : READAHEAD_BUFFER_SIZE;
+	buffer_count = buffer_count > 1 ? buffer_count : READAHEAD_BUFFER_COUNT;
+
+	file_readahead_t* readahead = calloc(1, sizeof(file_readahead_t));
+	light_file fd = calloc(1, sizeof(struct light_file_t));
+	if (readahead == NULL || fd == NULL) {
+		free(readahead);
+		free(fd);
+		fclose(file);
+		return NULL;
+	}
+	readahead->file = file;
+	readahead->buffer_size = buffer_size;
+	light_mutex_init(&readahead->mutex);
+	light_cond_init(&readahead->cond);
+
+	readahead->buffers = calloc(buffer_count, sizeof(readahead_buffer));
+	bool ready = readahead->buffers != NULL;
+	if (ready) {
+		readahead->buffer_count = buffer_count;
+		for (uint32_t i = 0; i < buffer_count && ready; i++) {
+			readahead->buffers[i].data = __aligned_alloc(buffer_size);
+			ready = readahead->buffers[i].data != NULL;
+		}
+	}
+	// Reads are whole buffers already, stdio buffering would only add a copy
+	ready = ready && setvbuf(file, NULL, _IONBF, 0) == 0 && __readahead_start(readahead) == 0;
+	if (!ready) {
+		fclose(file);
+		__readahead_free(readahead);
+		free(fd);
+		return NULL;
+	}
+
+	fd->context = readahead;
+	fd->fn_read = &light_readahead_read;
+	fd->fn_seek = &light_readahead_seek;
+	fd->fn_tell = &light_readahead_tell;
+	fd->fn_close = &light_readahead_close;
+	return fd;
+}
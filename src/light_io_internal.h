@@ -24,12 +24,17 @@
 
 #include "light_io.h"
 #include <stdio.h> 
+#include <stdint.h>
+#include <stdbool.h>
 
 typedef size_t(*light_fn_read)(void* context, void* buf, size_t count);
 typedef size_t(*light_fn_write)(void* context, const void* buf, size_t count);
 typedef int64_t(*light_fn_seek)(void* context, int64_t offset, int origin);
+typedef int64_t(*light_fn_tell)(void* context);
 typedef int(*light_fn_flush)(void* context);
 typedef int(*light_fn_close)(void* context);
+// Returns a pointer to the next count bytes and consumes them, or NULL without consuming anything
+typedef const void*(*light_fn_borrow)(void* context, size_t count);
 
 struct light_file_t
 {
@@ -38,8 +43,49 @@ struct light_file_t
 	light_fn_read fn_read;
 	light_fn_write fn_write;
 	light_fn_seek fn_seek;
+	light_fn_tell fn_tell;
 	light_fn_flush fn_flush;
 	light_fn_close fn_close;
+	light_fn_borrow fn_borrow;
+
+	// Scratch memory reused by the block reader, released on close
+	uint8_t* buffer;
+	size_t buffer_size;
+
+	// Header of the next block, once peeked and until it is read or skipped
+	bool peeked;
+	uint32_t peeked_type;
+	uint32_t peeked_length;
+	uint32_t peeked_magic;
+	// Leading bytes of the peeked block already consumed from the file
+	const uint8_t* peeked_body;
+	uint32_t peeked_body_length;
+	// Where the peeked block starts, -1 when unknown
+	int64_t peeked_offset;
+
+	// Bytes consumed from the start of the file, -1 once unknown
+	int64_t position;
+
+	// Bytes handed back with light_io_unread, served before the backend
+	uint8_t* unread;
+	size_t unread_size;
+	size_t unread_offset;
 };
 
+// Returns a buffer owned by fd of at least size bytes, the content is not preserved
+uint8_t* light_io_reserve(light_file fd, size_t size);
+
+// Same as light_io_reserve, but the first keep bytes of the buffer are preserved
+uint8_t* light_io_grow(light_file fd, size_t size, size_t keep);
+
+// Puts count bytes back in front of the file, the next reads return them first
+int light_io_unread(light_file fd, const void* data, size_t count);
+
+// Returns the next count bytes in place when the backend supports it, NULL otherwise
+// Borrowed memory stays valid until the file is closed
+const uint8_t* light_io_borrow(light_file fd, size_t count);
+
+// Tells if data points into the scratch buffer of fd, which the next read reuses
+bool light_io_in_buffer(light_file fd, const void* data);
+
 #endif /* INCLUDE_LIGHT_IO_INTERNAL_H_ */
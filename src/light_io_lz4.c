@@ -0,0 +1,329 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifdef LIGHT_USE_LZ4
+
+#include "light_io.h"
+#include "light_io_internal.h"
+#include "light_io_lz4.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <lz4frame.h>      // presumes lz4 library is installed
+
+// Writes are compressed by chunks of at most this size, which bounds the output buffer
+#define COMPRESSION_CHUNK_SIZE (64 * 1024)
+#define DECOMPRESSION_BUFFER_IN_SIZE (64 * 1024)
+// Seeking forwards decompresses through this much at a time
+#define SKIP_BUFFER_SIZE (64 * 1024)
+
+struct lz4_compression_t
+{
+	FILE* file;
+	LZ4F_cctx* cctx;
+	LZ4F_preferences_t preferences;
+	uint8_t* buffer_out;
+	size_t buffer_out_size;
+	int64_t position;
+};
+
+struct lz4_decompression_t
+{
+	FILE* file;
+	LZ4F_dctx* dctx;
+	uint8_t* buffer_in;
+	size_t in_pos;
+	size_t in_size;
+	int64_t position;
+};
+
+static int64_t __file_seek(FILE* file, int64_t offset, int origin)
+{
+#if _WIN32
+	return _fseeki64(file, offset, origin);
+#elif (HAVE_FSEEKO64 + 0)
+	return fseeko64(file, offset, origin);
+#else
+	return fseek(file, offset, origin);
+#endif
+}
+
+static bool __write_out(struct lz4_compression_t* compression, size_t size)
+{
+	if (LZ4F_isError(size)) {
+		return false;
+	}
+	return fwrite(compression->buffer_out, 1, size, compression->file) == size;
+}
+
+static size_t light_lz4_write(void* context, const void* buf, size_t count)
+{
+	struct lz4_compression_t* compression = context;
+	const uint8_t* src = buf;
+	size_t done = 0;
+	while (done < count) {
+		size_t chunk = count - done < COMPRESSION_CHUNK_SIZE ? count - done : COMPRESSION_CHUNK_SIZE;
+		size_t res = LZ4F_compressUpdate(compression->cctx, compression->buffer_out, compression->buffer_out_size,
+			src + done, chunk, NULL);
+		if (!__write_out(compression, res)) {
+			break;
+		}
+		done += chunk;
+	}
+	compression->position += (int64_t)done;
+	return done;
+}
+
+static int light_lz4_flush(void* context)
+{
+	struct lz4_compression_t* compression = context;
+	// Ends the current block early, so that everything written so far can be read back
+	size_t res = LZ4F_flush(compression->cctx, compression->buffer_out, compression->buffer_out_size, NULL);
+	if (!__write_out(compression, res)) {
+		return -1;
+	}
+	return fflush(compression->file);
+}
+
+static int64_t light_lz4_tell_w(void* context)
+{
+	struct lz4_compression_t* compression = context;
+	return compression->position;
+}
+
+static void __free_compression(struct lz4_compression_t* compression)
+{
+	LZ4F_freeCompressionContext(compression->cctx);
+	free(compression->buffer_out);
+	free(compression);
+}
+
+static int light_lz4_close_w(void* context)
+{
+	struct lz4_compression_t* compression = context;
+	size_t res = LZ4F_compressEnd(compression->cctx, compression->buffer_out, compression->buffer_out_size, NULL);
+	bool ok = __write_out(compression, res);
+	ok &= fclose(compression->file) == 0;
+	__free_compression(compression);
+	return ok ? 0 : -1;
+}
+
+static size_t light_lz4_read(void* context, void* buf, size_t count)
+{
+	struct lz4_decompression_t* decompression = context;
+	uint8_t* dst = buf;
+	size_t done = 0;
+	while (done < count) {
+		if (decompression->in_pos == decompression->in_size) {
+			decompression->in_size = fread(decompression->buffer_in, 1, DECOMPRESSION_BUFFER_IN_SIZE, decompression->file);
+			decompression->in_pos = 0;
+			if (decompression->in_size == 0) {
+				break;
+			}
+		}
+		// Straight into the caller's buffer, LZ4F stages blocks that do not fit by itself
+		size_t dst_size = count - done;
+		size_t src_size = decompression->in_size - decompression->in_pos;
+		size_t res = LZ4F_decompress(decompression->dctx, dst + done, &dst_size,
+			decompression->buffer_in + decompression->in_pos, &src_size, NULL);
+		if (LZ4F_isError(res)) {
+			break;
+		}
+		// At the end of a frame, 0, the next one starts over with a frame header
+		decompression->in_pos += src_size;
+		done += dst_size;
+	}
+	decompression->position += (int64_t)done;
+	return done;
+}
+
+static int64_t light_lz4_tell_r(void* context)
+{
+	struct lz4_decompression_t* decompression = context;
+	return decompression->position;
+}
+
+static int64_t light_lz4_seek(void* context, int64_t offset, int origin)
+{
+	struct lz4_decompression_t* decompression = context;
+	if (origin == SEEK_CUR) {
+		offset += decompression->position;
+	}
+	else if (origin != SEEK_SET) {
+		return -1;
+	}
+	if (offset < 0) {
+		return -1;
+	}
+
+	if (offset < decompression->position) {
+		// Backwards means decompressing again from the start
+		if (__file_seek(decompression->file, 0, SEEK_SET) != 0) {
+			return -1;
+		}
+		LZ4F_resetDecompressionContext(decompression->dctx);
+		decompression->in_pos = 0;
+		decompression->in_size = 0;
+		decompression->position = 0;
+	}
+
+	uint8_t skip[SKIP_BUFFER_SIZE];
+	while (decompression->position < offset) {
+		int64_t left = offset - decompression->position;
+		size_t n = left < (int64_t)sizeof(skip) ? (size_t)left : sizeof(skip);
+		if (light_lz4_read(decompression, skip, n) != n) {
+			return -1;
+		}
+	}
+	return decompression->position;
+}
+
+static int light_lz4_close_r(void* context)
+{
+	struct lz4_decompression_t* decompression = context;
+	LZ4F_freeDecompressionContext(decompression->dctx);
+	int res = fclose(decompression->file);
+	free(decompression->buffer_in);
+	free(decompression);
+	return res;
+}
+
+static struct lz4_compression_t* __open_compression(FILE* file, int level)
+{
+	struct lz4_compression_t* compression = calloc(1, sizeof(struct lz4_compression_t));
+	if (compression == NULL) {
+		return NULL;
+	}
+	compression->file = file;
+	// Independent blocks, each one decodable without the ones before it
+	compression->preferences.frameInfo.blockMode = LZ4F_blockIndependent;
+	compression->preferences.frameInfo.blockSizeID = LZ4F_max256KB;
+	compression->preferences.compressionLevel = level;
+	compression->buffer_out_size = LZ4F_compressBound(COMPRESSION_CHUNK_SIZE, &compression->preferences);
+	if (compression->buffer_out_size < LZ4F_HEADER_SIZE_MAX) {
+		compression->buffer_out_size = LZ4F_HEADER_SIZE_MAX;
+	}
+	compression->buffer_out = malloc(compression->buffer_out_size);
+	if (compression->buffer_out == NULL || LZ4F_isError(LZ4F_createCompressionContext(&compression->cctx, LZ4F_VERSION))) {
+		__free_compression(compression);
+		return NULL;
+	}
+	size_t res = LZ4F_compressBegin(compression->cctx, compression->buffer_out, compression->buffer_out_size,
+		&compression->preferences);
+	if (!__write_out(compression, res)) {
+		__free_compression(compression);
+		return NULL;
+	}
+	return compression;
+}
+
+static struct lz4_decompression_t* __open_decompression(FILE* file)
+{
+	struct lz4_decompression_t* decompression = calloc(1, sizeof(struct lz4_decompression_t));
+	if (decompression == NULL) {
+		return NULL;
+	}
+	decompression->file = file;
+	decompression->buffer_in = malloc(DECOMPRESSION_BUFFER_IN_SIZE);
+	if (decompression->buffer_in == NULL || LZ4F_isError(LZ4F_createDecompressionContext(&decompression->dctx, LZ4F_VERSION))) {
+		free(decompression->buffer_in);
+		free(decompression);
+		return NULL;
+	}
+	return decompression;
+}
+
+light_file light_io_lz4_open(const char* filename, const char* mode)
+{
+	// 0 level means the default fast compressor
+	int compression_level = 0;
+
+	// parse mode
+	bool read = false;
+	bool write = false;
+	bool append = false;
+	while (mode && *mode)
+	{
+		if (*mode >= '0' && *mode <= '9') {
+			compression_level = *mode - '0';
+		}
+		else {
+			switch (*mode)
+			{
+			case 'b':
+				break;
+			case 'r':
+				read = true;
+				break;
+			case 'w':
+				write = true;
+				break;
+			case 'a':
+				append = true;
+				break;
+			default:
+				return NULL;
+			}
+		}
+		mode++;
+	}
+	if (read + write + append != 1) {
+		return NULL;
+	}
+
+	// Frames concatenate, so appending is just another frame at the end
+	FILE* file = fopen(filename, read ? "rb" : append ? "ab" : "wb");
+	if (!file)
+	{
+		return NULL;
+	}
+
+	light_file fd = calloc(1, sizeof(struct light_file_t));
+	if (read) {
+		struct lz4_decompression_t* decompression = __open_decompression(file);
+		if (decompression == NULL) {
+			fclose(file);
+			free(fd);
+			return NULL;
+		}
+		fd->context = decompression;
+		fd->fn_read = &light_lz4_read;
+		fd->fn_seek = &light_lz4_seek;
+		fd->fn_tell = &light_lz4_tell_r;
+		fd->fn_close = &light_lz4_close_r;
+	}
+	else {
+		struct lz4_compression_t* compression = __open_compression(file, compression_level);
+		if (compression == NULL) {
+			fclose(file);
+			free(fd);
+			return NULL;
+		}
+		fd->context = compression;
+		fd->fn_write = &light_lz4_write;
+		fd->fn_flush = &light_lz4_flush;
+		fd->fn_tell = &light_lz4_tell_w;
+		fd->fn_close = &light_lz4_close_w;
+	}
+	return fd;
+}
+
+#endif // LIGHT_USE_LZ4
@@ -46,6 +46,19 @@ static size_t light_mem_read(void* context, void* buf, size_t count)
 	return len;
 }
 
+static const void* light_mem_borrow(void* context, size_t count)
+{
+	mem_context* mem = context;
+	if (count > mem->size - mem->offset) {
+		return NULL;
+	}
+
+	const uint8_t* data = mem->data + mem->offset;
+	mem->offset += count;
+
+	return data;
+}
+
 static size_t light_mem_write(void* context, const void* buf, size_t count)
 {
 	mem_context* mem = context;
@@ -62,26 +75,34 @@ static size_t light_mem_write(void* context, const void* buf, size_t count)
 static int64_t light_mem_seek(void* context, int64_t offset, int origin)
 {
 	mem_context* mem = context;
-	size_t new_offset = -1;
+	int64_t new_offset;
 	switch (origin)
 	{
 	case SEEK_SET:
 		new_offset = offset;
 		break;
 	case	SEEK_CUR:
-		new_offset += offset;
+		new_offset = (int64_t)mem->offset + offset;
 		break;
 	case	SEEK_END:
-		new_offset = mem->size + offset;
+		new_offset = (int64_t)mem->size + offset;
 		break;
+	default:
+		return -1;
 	}
-	if (new_offset < 0 || new_offset > mem->size) {
-		return 1;
+	if (new_offset < 0 || (uint64_t)new_offset > mem->size) {
+		return -1;
 	}
-	mem->offset = new_offset;
+	mem->offset = (size_t)new_offset;
 	return 0;
 }
 
+static int64_t light_mem_tell(void* context)
+{
+	mem_context* mem = context;
+	return (int64_t)mem->offset;
+}
+
 static int light_mem_flush(void* context)
 {
 	return 0;
@@ -108,7 +129,9 @@ light_file light_io_mem_create(void* memory, size_t size)
 	fd->fn_read = &light_mem_read;
 	fd->fn_write = &light_mem_write;
 	fd->fn_seek = &light_mem_seek;
+	fd->fn_tell = &light_mem_tell;
 	fd->fn_flush = &light_mem_flush;
 	fd->fn_close = &light_mem_close;
+	fd->fn_borrow = &light_mem_borrow;
 	return fd;
 }
\ No newline at end of file
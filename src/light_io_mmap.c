@@ -0,0 +1,219 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "light_io_mmap.h"
+#include "light_io_internal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+typedef struct mmap_context
+{
+	const uint8_t* data;
+	size_t offset;
+	size_t size;
+#if defined(_WIN32)
+	HANDLE file;
+	HANDLE mapping;
+#endif
+} mmap_context;
+
+static size_t light_mmap_read(void* context, void* buf, size_t count)
+{
+	mmap_context* map = context;
+	size_t remaining = map->size - map->offset;
+	size_t len = count < remaining ? count : remaining;
+
+	memcpy(buf, map->data + map->offset, len);
+
+	map->offset += len;
+
+	return len;
+}
+
+static const void* light_mmap_borrow(void* context, size_t count)
+{
+	mmap_context* map = context;
+	if (count > map->size - map->offset) {
+		return NULL;
+	}
+
+	const uint8_t* data = map->data + map->offset;
+	map->offset += count;
+
+	return data;
+}
+
+static int64_t light_mmap_seek(void* context, int64_t offset, int origin)
+{
+	mmap_context* map = context;
+	int64_t new_offset;
+	switch (origin)
+	{
+	case SEEK_SET:
+		new_offset = offset;
+		break;
+	case SEEK_CUR:
+		new_offset = (int64_t)map->offset + offset;
+		break;
+	case SEEK_END:
+		new_offset = (int64_t)map->size + offset;
+		break;
+	default:
+		return -1;
+	}
+	if (new_offset < 0 || (uint64_t)new_offset > map->size) {
+		return -1;
+	}
+	map->offset = (size_t)new_offset;
+	return 0;
+}
+
+static int64_t light_mmap_tell(void* context)
+{
+	mmap_context* map = context;
+	return (int64_t)map->offset;
+}
+
+static int light_mmap_close(void* context)
+{
+	mmap_context* map = context;
+	int res = 0;
+#if defined(_WIN32)
+	if (map->data) {
+		res |= !UnmapViewOfFile(map->data);
+	}
+	if (map->mapping) {
+		res |= !CloseHandle(map->mapping);
+	}
+	res |= !CloseHandle(map->file);
+#else
+	if (map->data) {
+		res = munmap((void*)map->data, map->size);
+	}
+#endif
+	free(map);
+	return res;
+}
+
+#if defined(_WIN32)
+
+static int light_mmap_map(mmap_context* map, const char* filename)
+{
+	map->file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (map->file == INVALID_HANDLE_VALUE) {
+		return -1;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(map->file, &size) || (uint64_t)size.QuadPart > SIZE_MAX) {
+		CloseHandle(map->file);
+		return -1;
+	}
+	map->size = (size_t)size.QuadPart;
+	if (map->size == 0) {
+		// Empty files can not be mapped, there is nothing to read anyway
+		return 0;
+	}
+
+	map->mapping = CreateFileMappingA(map->file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (map->mapping != NULL) {
+		map->data = MapViewOfFile(map->mapping, FILE_MAP_READ, 0, 0, 0);
+	}
+	if (map->data == NULL) {
+		if (map->mapping != NULL) {
+			CloseHandle(map->mapping);
+		}
+		CloseHandle(map->file);
+		return -1;
+	}
+	return 0;
+}
+
+#else
+
+static int light_mmap_map(mmap_context* map, const char* filename)
+{
+	int file = open(filename, O_RDONLY);
+	if (file < 0) {
+		return -1;
+	}
+
+	struct stat info;
+	if (fstat(file, &info) != 0 || (uint64_t)info.st_size > SIZE_MAX) {
+		close(file);
+		return -1;
+	}
+	map->size = (size_t)info.st_size;
+	if (map->size == 0) {
+		// Empty files can not be mapped, there is nothing to read anyway
+		close(file);
+		return 0;
+	}
+
+	void* data = mmap(NULL, map->size, PROT_READ, MAP_PRIVATE, file, 0);
+	// The mapping keeps its own reference on the file
+	close(file);
+	if (data == MAP_FAILED) {
+		return -1;
+	}
+#if defined(MADV_SEQUENTIAL)
+	madvise(data, map->size, MADV_SEQUENTIAL);
+#endif
+	map->data = data;
+	return 0;
+}
+
+#endif
+
+light_file light_io_mmap_open(const char* filename)
+{
+	if (!filename)
+	{
+		return NULL;
+	}
+	mmap_context* map = calloc(1, sizeof(struct mmap_context));
+	if (light_mmap_map(map, filename) != 0)
+	{
+		free(map);
+		return NULL;
+	}
+
+	light_file fd = calloc(1, sizeof(struct light_file_t));
+	fd->context = map;
+	fd->fn_read = &light_mmap_read;
+	fd->fn_seek = &light_mmap_seek;
+	fd->fn_tell = &light_mmap_tell;
+	fd->fn_close = &light_mmap_close;
+	fd->fn_borrow = &light_mmap_borrow;
+	return fd;
+}
@@ -0,0 +1,509 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "light_io_uring.h"
+#include "light_io_internal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(LIGHT_USE_URING)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Buffers kept in flight, each is one read or write request
+#define URING_BUFFER_COUNT 4
+#define URING_BUFFER_SIZE (1024 * 1024)
+
+typedef struct uring_buffer {
+	uint8_t* data;
+	// Bytes read into the buffer, or waiting in it to be written
+	size_t size;
+	int64_t offset;
+	bool in_flight;
+} uring_buffer;
+
+typedef struct uring_context {
+	int fd;
+	int ring_fd;
+	bool writing;
+	bool registered;
+	bool failed;
+
+	// Rings shared with the kernel
+	void* sq_ring;
+	size_t sq_ring_size;
+	void* cq_ring;
+	size_t cq_ring_size;
+	struct io_uring_sqe* sqes;
+	size_t sqes_size;
+	uint32_t* sq_tail;
+	uint32_t* sq_mask;
+	uint32_t* sq_array;
+	uint32_t* cq_head;
+	uint32_t* cq_tail;
+	uint32_t* cq_mask;
+	struct io_uring_cqe* cqes;
+
+	// Buffers are used round robin, current is the one being read from or written into
+	uring_buffer buffers[URING_BUFFER_COUNT];
+	uint32_t current;
+	size_t consumed;
+	int64_t position;
+	// File offset of the next request
+	int64_t next_offset;
+} uring_context;
+
+static int __uring_enter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+	return (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int __uring_submit(uring_context* uring, uint32_t index, size_t length)
+{
+	uring_buffer* buffer = &uring->buffers[index];
+	uint32_t tail = *uring->sq_tail;
+	uint32_t slot = tail & *uring->sq_mask;
+	struct io_uring_sqe* sqe = &uring->sqes[slot];
+
+	memset(sqe, 0, sizeof(*sqe));
+	if (uring->registered) {
+		sqe->opcode = uring->writing ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+		sqe->buf_index = (uint16_t)index;
+	}
+	else {
+		sqe->opcode = uring->writing ? IORING_OP_WRITE : IORING_OP_READ;
+	}
+	sqe->fd = uring->fd;
+	sqe->addr = (uint64_t)(uintptr_t)buffer->data;
+	sqe->len = (uint32_t)length;
+	sqe->off = (uint64_t)buffer->offset;
+	sqe->user_data = index;
+
+	uring->sq_array[slot] = slot;
+	__atomic_store_n(uring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+	buffer->in_flight = true;
+
+	// There are never more requests than submission entries, the kernel takes this one right away
+	while (__uring_enter(uring->ring_fd, 1, 0, 0) < 0) {
+		if (errno != EINTR) {
+			buffer->in_flight = false;
+			uring->failed = true;
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static void __uring_complete(uring_context* uring, uring_buffer* buffer, int32_t result)
+{
+	buffer->in_flight = false;
+	if (result < 0) {
+		uring->failed = true;
+		buffer->size = 0;
+		return;
+	}
+
+	// Short transfers are rare on regular files, finish them synchronously
+	size_t done = (size_t)result;
+	size_t wanted = uring->writing ? buffer->size : URING_BUFFER_SIZE;
+	while (done < wanted) {
+		ssize_t res = uring->writing
+			? pwrite(uring->fd, buffer->data + done, wanted - done, buffer->offset + (int64_t)done)
+			: pread(uring->fd, buffer->data + done, wanted - done, buffer->offset + (int64_t)done);
+		if (res < 0 && errno == EINTR) {
+			continue;
+		}
+		if (res < 0) {
+			uring->failed = true;
+		}
+		if (res <= 0) {
+			break;
+		}
+		done += (size_t)res;
+	}
+	// Written buffers are free again
+	buffer->size = uring->writing ? 0 : done;
+}
+
+static int __uring_wait(uring_context* uring, uint32_t index)
+{
+	while (uring->buffers[index].in_flight) {
+		uint32_t head = *uring->cq_head;
+		if (head == __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE)) {
+			if (__uring_enter(uring->ring_fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+				uring->failed = true;
+				return -1;
+			}
+			continue;
+		}
+		struct io_uring_cqe* cqe = &uring->cqes[head & *uring->cq_mask];
+		__uring_complete(uring, &uring->buffers[cqe->user_data], cqe->res);
+		__atomic_store_n(uring->cq_head, head + 1, __ATOMIC_RELEASE);
+	}
+	return 0;
+}
+
+static int __uring_wait_all(uring_context* uring)
+{
+	int res = 0;
+	for (uint32_t i = 0; i < URING_BUFFER_COUNT; i++) {
+		res |= __uring_wait(uring, i);
+	}
+	return res;
+}
+
+static int __uring_read_ahead(uring_context* uring, uint32_t index)
+{
+	uring_buffer* buffer = &uring->buffers[index];
+	buffer->offset = uring->next_offset;
+	buffer->size = 0;
+	uring->next_offset += URING_BUFFER_SIZE;
+	return __uring_submit(uring, index, URING_BUFFER_SIZE);
+}
+
+// Starts reading every buffer from position on
+static int __uring_restart_reads(uring_context* uring)
+{
+	uring->current = 0;
+	uring->consumed = 0;
+	uring->next_offset = uring->position;
+	for (uint32_t i = 0; i < URING_BUFFER_COUNT; i++) {
+		if (__uring_read_ahead(uring, i) != 0) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+// Copies count bytes out of the buffers into buf, or only steps over them when buf is NULL
+static size_t __uring_consume(uring_context* uring, uint8_t* buf, size_t count)
+{
+	size_t done = 0;
+	while (done < count && !uring->failed) {
+		uring_buffer* buffer = &uring->buffers[uring->current];
+		if (__uring_wait(uring, uring->current) != 0) {
+			break;
+		}
+		if (uring->consumed == buffer->size) {
+			// A short buffer is the end of the file
+			if (buffer->size < URING_BUFFER_SIZE) {
+				break;
+			}
+			__uring_read_ahead(uring, uring->current);
+			uring->current = (uring->current + 1) % URING_BUFFER_COUNT;
+			uring->consumed = 0;
+			continue;
+		}
+
+		size_t available = buffer->size - uring->consumed;
+		size_t chunk = count - done < available ? count - done : available;
+		if (buf != NULL) {
+			memcpy(buf + done, buffer->data + uring->consumed, chunk);
+		}
+		uring->consumed += chunk;
+		done += chunk;
+	}
+	uring->position += (int64_t)done;
+	return done;
+}
+
+static size_t light_uring_read(void* context, void* buf, size_t count)
+{
+	return __uring_consume(context, buf, count);
+}
+
+static int __uring_write_current(uring_context* uring)
+{
+	uring_buffer* buffer = &uring->buffers[uring->current];
+	if (buffer->size == 0) {
+		return 0;
+	}
+	buffer->offset = uring->next_offset;
+	uring->next_offset += (int64_t)buffer->size;
+	uring->current = (uring->current + 1) % URING_BUFFER_COUNT;
+	return __uring_submit(uring, (uint32_t)(buffer - uring->buffers), buffer->size);
+}
+
+static size_t light_uring_write(void* context, const void* buf, size_t count)
+{
+	uring_context* uring = context;
+	size_t done = 0;
+	while (done < count && !uring->failed) {
+		uring_buffer* buffer = &uring->buffers[uring->current];
+		if (__uring_wait(uring, uring->current) != 0) {
+			break;
+		}
+		size_t space = URING_BUFFER_SIZE - buffer->size;
+		size_t chunk = count - done < space ? count - done : space;
+		memcpy(buffer->data + buffer->size, (const uint8_t*)buf + done, chunk);
+		buffer->size += chunk;
+		done += chunk;
+		if (buffer->size == URING_BUFFER_SIZE) {
+			__uring_write_current(uring);
+		}
+	}
+	uring->position += (int64_t)done;
+	return done;
+}
+
+static int light_uring_flush(void* context)
+{
+	uring_context* uring = context;
+	if (uring->writing) {
+		__uring_write_current(uring);
+		__uring_wait_all(uring);
+	}
+	return uring->failed ? -1 : 0;
+}
+
+static int64_t light_uring_seek(void* context, int64_t offset, int origin)
+{
+	uring_context* uring = context;
+	int64_t target;
+	struct stat info;
+	switch (origin)
+	{
+	case SEEK_SET:
+		target = offset;
+		break;
+	case SEEK_CUR:
+		target = uring->position + offset;
+		break;
+	case SEEK_END:
+		if (fstat(uring->fd, &info) != 0) {
+			return -1;
+		}
+		target = (int64_t)info.st_size + offset;
+		break;
+	default:
+		return -1;
+	}
+	if (target < 0) {
+		return -1;
+	}
+
+	// Forwards within the reads already submitted: step over the data and keep them, skipping
+	// a packet must not throw away what was read ahead
+	if (!uring->writing && !uring->failed && target >= uring->position && target < uring->next_offset) {
+		size_t distance = (size_t)(target - uring->position);
+		if (__uring_consume(uring, NULL, distance) < distance) {
+			if (uring->failed) {
+				return -1;
+			}
+			// Past the end of the file, reads there see the end
+			uring->position = target;
+		}
+		return 0;
+	}
+
+	light_uring_flush(uring);
+	__uring_wait_all(uring);
+	if (uring->failed) {
+		return -1;
+	}
+	uring->position = target;
+	if (uring->writing) {
+		uring->next_offset = target;
+		return 0;
+	}
+	return __uring_restart_reads(uring);
+}
+
+static int64_t light_uring_tell(void* context)
+{
+	uring_context* uring = context;
+	return uring->position;
+}
+
+static void __uring_free(uring_context* uring)
+{
+	if (uring->sqes != NULL) {
+		munmap(uring->sqes, uring->sqes_size);
+	}
+	if (uring->cq_ring != NULL && uring->cq_ring != uring->sq_ring) {
+		munmap(uring->cq_ring, uring->cq_ring_size);
+	}
+	if (uring->sq_ring != NULL) {
+		munmap(uring->sq_ring, uring->sq_ring_size);
+	}
+	if (uring->ring_fd >= 0) {
+		close(uring->ring_fd);
+	}
+	for (uint32_t i = 0; i < URING_BUFFER_COUNT; i++) {
+		free(uring->buffers[i].data);
+	}
+	free(uring);
+}
+
+static int light_uring_close(void* context)
+{
+	uring_context* uring = context;
+	int res = light_uring_flush(uring);
+	__uring_wait_all(uring);
+	res |= close(uring->fd);
+	__uring_free(uring);
+	return res;
+}
+
+static int __uring_setup(uring_context* uring)
+{
+	struct io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	uring->ring_fd = (int)syscall(__NR_io_uring_setup, URING_BUFFER_COUNT, &params);
+	if (uring->ring_fd < 0) {
+		return -1;
+	}
+
+	uring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+	uring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (single_mmap) {
+		uring->sq_ring_size = uring->cq_ring_size = uring->sq_ring_size > uring->cq_ring_size ? uring->sq_ring_size : uring->cq_ring_size;
+	}
+
+	void* sq_ring = mmap(NULL, uring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->ring_fd, IORING_OFF_SQ_RING);
+	if (sq_ring == MAP_FAILED) {
+		return -1;
+	}
+	uring->sq_ring = sq_ring;
+	if (single_mmap) {
+		uring->cq_ring = sq_ring;
+	}
+	else {
+		void* cq_ring = mmap(NULL, uring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->ring_fd, IORING_OFF_CQ_RING);
+		if (cq_ring == MAP_FAILED) {
+			return -1;
+		}
+		uring->cq_ring = cq_ring;
+	}
+	uring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+	void* sqes = mmap(NULL, uring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->ring_fd, IORING_OFF_SQES);
+	if (sqes == MAP_FAILED) {
+		return -1;
+	}
+	uring->sqes = sqes;
+
+	uint8_t* sq = uring->sq_ring;
+	uint8_t* cq = uring->cq_ring;
+	uring->sq_tail = (uint32_t*)(sq + params.sq_off.tail);
+	uring->sq_mask = (uint32_t*)(sq + params.sq_off.ring_mask);
+	uring->sq_array = (uint32_t*)(sq + params.sq_off.array);
+	uring->cq_head = (uint32_t*)(cq + params.cq_off.head);
+	uring->cq_tail = (uint32_t*)(cq + params.cq_off.tail);
+	uring->cq_mask = (uint32_t*)(cq + params.cq_off.ring_mask);
+	uring->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+
+	// Registered buffers save the kernel from mapping them on every request, it is fine without
+	struct iovec iovecs[URING_BUFFER_COUNT];
+	for (uint32_t i = 0; i < URING_BUFFER_COUNT; i++) {
+		iovecs[i].iov_base = uring->buffers[i].data;
+		iovecs[i].iov_len = URING_BUFFER_SIZE;
+	}
+	uring->registered = syscall(__NR_io_uring_register, uring->ring_fd, IORING_REGISTER_BUFFERS, iovecs, URING_BUFFER_COUNT) == 0;
+	return 0;
+}
+
+light_file light_io_uring_open(const char* filename, const char* mode)
+{
+	if (!filename || !mode) {
+		return NULL;
+	}
+	int flags;
+	if (strchr(mode, 'r') != NULL && strchr(mode, '+') == NULL) {
+		flags = O_RDONLY;
+	}
+	else if (strchr(mode, 'w') != NULL && strchr(mode, '+') == NULL) {
+		flags = O_WRONLY | O_CREAT | O_TRUNC;
+	}
+	else if (strchr(mode, 'a') != NULL && strchr(mode, '+') == NULL) {
+		flags = O_WRONLY | O_CREAT;
+	}
+	else {
+		return NULL;
+	}
+
+	uring_context* uring = calloc(1, sizeof(uring_context));
+	if (uring == NULL) {
+		return NULL;
+	}
+	uring->ring_fd = -1;
+	uring->writing = flags != O_RDONLY;
+	for (uint32_t i = 0; i < URING_BUFFER_COUNT; i++) {
+		if (posix_memalign((void**)&uring->buffers[i].data, 4096, URING_BUFFER_SIZE) != 0) {
+			uring->buffers[i].data = NULL;
+			__uring_free(uring);
+			return NULL;
+		}
+	}
+	if (__uring_setup(uring) != 0) {
+		__uring_free(uring);
+		return NULL;
+	}
+
+	uring->fd = open(filename, flags | O_CLOEXEC, 0666);
+	if (uring->fd < 0) {
+		__uring_free(uring);
+		return NULL;
+	}
+	struct stat info;
+	if (strchr(mode, 'a') != NULL && fstat(uring->fd, &info) == 0) {
+		uring->position = (int64_t)info.st_size;
+	}
+	uring->next_offset = uring->position;
+	if (!uring->writing && __uring_restart_reads(uring) != 0) {
+		__uring_wait_all(uring);
+		close(uring->fd);
+		__uring_free(uring);
+		return NULL;
+	}
+
+	light_file fd = calloc(1, sizeof(struct light_file_t));
+	fd->context = uring;
+	fd->fn_read = uring->writing ? NULL : &light_uring_read;
+	fd->fn_write = uring->writing ? &light_uring_write : NULL;
+	fd->fn_seek = &light_uring_seek;
+	fd->fn_tell = &light_uring_tell;
+	fd->fn_flush = &light_uring_flush;
+	fd->fn_close = &light_uring_close;
+	fd->position = uring->position;
+	return fd;
+}
+
+#else
+
+light_file light_io_uring_open(const char* filename, const char* mode)
+{
+	(void)filename;
+	(void)mode;
+	return NULL;
+}
+
+#endif
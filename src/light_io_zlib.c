@@ -6,10 +6,100 @@
 #include "light_io.h"
 #include "light_io_internal.h"
 #include "light_io_zlib.h"
+#include "light_thread.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
 #include <zlib.h>      // presumes zlib library is installed
 
+#define INFLATE_BUFFER_IN_SIZE (128 * 1024)
+#define INFLATE_BUFFER_OUT_SIZE (64 * 1024)
+// Reads of at least this many bytes are inflated straight into the caller's buffer,
+// smaller ones (block headers) go through the staging buffer
+#define INFLATE_DIRECT_MIN_SIZE 4096
+
+// Writing on workers deflates blocks of this size, each one gzip member
+#define DEFLATE_BLOCK_SIZE (1024 * 1024)
+
+// Access points go every span of uncompressed data unless asked otherwise
+#define INDEX_DEFAULT_SPAN_MB 1
+#define INDEX_WINDOW_SIZE 32768
+// Index files are a header followed by the access points, in host byte order like .lidx files
+#define INDEX_MAGIC 0x58495A47 // GZIX
+#define INDEX_VERSION 1
+#define INDEX_SUFFIX ".gzidx"
+
+// Where inflating can start again without the data before it, as in zran.c of the zlib examples
+struct zlib_access_point_t
+{
+	uint64_t out;
+	// First whole byte of compressed data, bits more are taken from the byte before it
+	uint64_t in;
+	uint32_t bits;
+	uint32_t window_size;
+	uint8_t window[INDEX_WINDOW_SIZE];
+};
+
+struct zlib_index_t
+{
+	size_t count;
+	struct zlib_access_point_t* points;
+};
+
+struct zlib_index_header_t
+{
+	uint32_t magic;
+	uint32_t version;
+	// Size of the gzip file the index was built from
+	uint64_t compressed_size;
+	uint64_t count;
+};
+
+// Reading does not go through gzread: its internal buffer costs a copy on every read
+struct zlib_decompression_t
+{
+	FILE* file;
+	z_stream strm;
+	bool end;
+	// Raw deflate after an access point, the gzip trailer of the member then comes before the next one
+	bool raw;
+	// Access points of the sidecar index, NULL without one
+	struct zlib_index_t* index;
+
+	uint8_t* buffer_in;
+
+	uint8_t* buffer_out;
+	size_t out_pos;
+	size_t out_size;
+
+	// Uncompressed bytes handed out so far
+	int64_t position;
+};
+
+static int64_t __file_seek(FILE* file, int64_t offset, int origin)
+{
+#if _WIN32
+	return _fseeki64(file, offset, origin);
+#elif (HAVE_FSEEKO64 + 0)
+	return fseeko64(file, offset, origin);
+#else
+	return fseek(file, offset, origin);
+#endif
+}
+
+static int64_t __file_tell(FILE* file)
+{
+#if _WIN32
+	return _ftelli64(file);
+#elif (HAVE_FSEEKO64 + 0)
+	return ftello64(file);
+#else
+	return ftell(file);
+#endif
+}
+
 static size_t light_zlib_read(void* context, void* buf, size_t count)
 {
 	return gzread((gzFile)context, buf, count);
@@ -35,25 +125,764 @@ static int64_t light_zlib_seek(void* context, int64_t offset, int origin)
 
 }
 
+static int64_t light_zlib_tell(void* context)
+{
+#ifdef Z_LARGE64
+	return gztell64((gzFile)context);
+#else
+	return gztell((gzFile)context);
+#endif
+}
+
 static int light_zlib_close(void* context)
 {
 	return gzclose((gzFile)context);
 }
 
+// Makes input available, false at the end of the file
+static bool __fill_input(struct zlib_decompression_t* decompression)
+{
+	z_stream* strm = &decompression->strm;
+	if (strm->avail_in == 0) {
+		strm->avail_in = (uInt)fread(decompression->buffer_in, 1, INFLATE_BUFFER_IN_SIZE, decompression->file);
+		strm->next_in = decompression->buffer_in;
+	}
+	return strm->avail_in > 0;
+}
+
+// After the end of a member, goes on with the next one if there is one
+static bool __next_member(struct zlib_decompression_t* decompression)
+{
+	z_stream* strm = &decompression->strm;
+	if (decompression->raw) {
+		// Raw inflate leaves the 8 byte gzip trailer to us
+		for (int skip = 8; skip > 0;) {
+			if (!__fill_input(decompression)) {
+				return false;
+			}
+			uInt n = strm->avail_in < (uInt)skip ? strm->avail_in : (uInt)skip;
+			strm->next_in += n;
+			strm->avail_in -= n;
+			skip -= (int)n;
+		}
+	}
+	// Concatenated gzip members read as one stream
+	if (!__fill_input(decompression) || strm->next_in[0] != 0x1F) {
+		return false;
+	}
+	decompression->raw = false;
+	return inflateReset2(strm, 16 + MAX_WBITS) == Z_OK;
+}
+
+// Inflates at most size bytes into dst, 0 once the stream is over
+static size_t __inflate(struct zlib_decompression_t* decompression, uint8_t* dst, size_t size)
+{
+	z_stream* strm = &decompression->strm;
+	strm->next_out = dst;
+	strm->avail_out = (uInt)(size > UINT32_MAX ? UINT32_MAX : size);
+	uInt avail_out = strm->avail_out;
+
+	while (!decompression->end && strm->avail_out == avail_out) {
+		if (!__fill_input(decompression)) {
+			decompression->end = true;
+			break;
+		}
+		int res = inflate(strm, Z_NO_FLUSH);
+		if (res == Z_STREAM_END) {
+			decompression->end = !__next_member(decompression);
+		}
+		else if (res != Z_OK) {
+			decompression->end = true;
+		}
+	}
+	return avail_out - strm->avail_out;
+}
+
+static size_t light_zlib_read_inflate(void* context, void* buf, size_t count)
+{
+	struct zlib_decompression_t* decompression = context;
+	uint8_t* out = buf;
+	size_t bytes_read = 0;
+
+	while (bytes_read < count) {
+		// What is staged goes first
+		size_t staged = decompression->out_size - decompression->out_pos;
+		if (staged > 0) {
+			size_t n = count - bytes_read < staged ? count - bytes_read : staged;
+			memcpy(out + bytes_read, decompression->buffer_out + decompression->out_pos, n);
+			decompression->out_pos += n;
+			bytes_read += n;
+			continue;
+		}
+
+		size_t wanted = count - bytes_read;
+		if (wanted >= INFLATE_DIRECT_MIN_SIZE) {
+			size_t produced = __inflate(decompression, out + bytes_read, wanted);
+			if (produced == 0) {
+				break;
+			}
+			bytes_read += produced;
+		}
+		else {
+			decompression->out_pos = 0;
+			decompression->out_size = __inflate(decompression, decompression->buffer_out, INFLATE_BUFFER_OUT_SIZE);
+			if (decompression->out_size == 0) {
+				break;
+			}
+		}
+	}
+
+	decompression->position += (int64_t)bytes_read;
+	return bytes_read;
+}
+
+static int64_t light_zlib_tell_inflate(void* context)
+{
+	struct zlib_decompression_t* decompression = context;
+	return decompression->position;
+}
+
+static bool __restore_point(struct zlib_decompression_t* decompression, const struct zlib_access_point_t* point)
+{
+	z_stream* strm = &decompression->strm;
+	if (__file_seek(decompression->file, (int64_t)point->in - (point->bits ? 1 : 0), SEEK_SET) != 0
+		|| inflateReset2(strm, -MAX_WBITS) != Z_OK) {
+		return false;
+	}
+	strm->avail_in = 0;
+	if (point->bits) {
+		int c = getc(decompression->file);
+		if (c == EOF || inflatePrime(strm, (int)point->bits, c >> (8 - point->bits)) != Z_OK) {
+			return false;
+		}
+	}
+	if (point->window_size > 0 && inflateSetDictionary(strm, point->window, point->window_size) != Z_OK) {
+		return false;
+	}
+	decompression->raw = true;
+	decompression->end = false;
+	decompression->out_pos = 0;
+	decompression->out_size = 0;
+	decompression->position = (int64_t)point->out;
+	return true;
+}
+
+static int64_t light_zlib_seek_inflate(void* context, int64_t offset, int origin)
+{
+	struct zlib_decompression_t* decompression = context;
+	if (origin == SEEK_CUR) {
+		offset += decompression->position;
+	}
+	else if (origin != SEEK_SET) {
+		return -1;
+	}
+	if (offset < 0) {
+		return -1;
+	}
+
+	// Last access point at or before the target
+	const struct zlib_access_point_t* point = NULL;
+	if (decompression->index != NULL && decompression->index->count > 0) {
+		const struct zlib_index_t* index = decompression->index;
+		size_t low = 0, high = index->count;
+		while (low < high) {
+			size_t middle = low + (high - low) / 2;
+			if (index->points[middle].out <= (uint64_t)offset) {
+				low = middle + 1;
+			}
+			else {
+				high = middle;
+			}
+		}
+		point = low > 0 ? &index->points[low - 1] : NULL;
+	}
+
+	bool forwards = offset >= decompression->position;
+	if (point != NULL && (!forwards || point->out > (uint64_t)decompression->position)) {
+		// Inflating from the access point saves everything before it
+		if (!__restore_point(decompression, point)) {
+			return -1;
+		}
+	}
+	else if (!forwards) {
+		// Backwards means inflating again from the start
+		if (__file_seek(decompression->file, 0, SEEK_SET) != 0 || inflateReset2(&decompression->strm, 16 + MAX_WBITS) != Z_OK) {
+			return -1;
+		}
+		decompression->strm.avail_in = 0;
+		decompression->raw = false;
+		decompression->end = false;
+		decompression->out_pos = 0;
+		decompression->out_size = 0;
+		decompression->position = 0;
+	}
+
+	// Forwards through the staging buffer
+	while (decompression->position < offset) {
+		size_t staged = decompression->out_size - decompression->out_pos;
+		if (staged == 0) {
+			decompression->out_pos = 0;
+			decompression->out_size = __inflate(decompression, decompression->buffer_out, INFLATE_BUFFER_OUT_SIZE);
+			if (decompression->out_size == 0) {
+				return -1;
+			}
+			continue;
+		}
+		size_t n = (uint64_t)(offset - decompression->position) < staged ? (size_t)(offset - decompression->position) : staged;
+		decompression->out_pos += n;
+		decompression->position += (int64_t)n;
+	}
+	return decompression->position;
+}
+
+static void __free_index(struct zlib_index_t* index)
+{
+	if (index != NULL) {
+		free(index->points);
+		free(index);
+	}
+}
+
+static int64_t __file_size(const char* filename)
+{
+	FILE* file = fopen(filename, "rb");
+	if (file == NULL) {
+		return -1;
+	}
+	int64_t size = __file_seek(file, 0, SEEK_END) == 0 ? __file_tell(file) : -1;
+	fclose(file);
+	return size;
+}
+
+static char* __index_path(const char* filename)
+{
+	size_t length = strlen(filename);
+	char* path = malloc(length + sizeof(INDEX_SUFFIX));
+	if (path != NULL) {
+		memcpy(path, filename, length);
+		memcpy(path + length, INDEX_SUFFIX, sizeof(INDEX_SUFFIX));
+	}
+	return path;
+}
+
+// NULL when there is no index or it was built from another file
+static struct zlib_index_t* __load_index(const char* index_path, int64_t compressed_size)
+{
+	FILE* file = fopen(index_path, "rb");
+	if (file == NULL) {
+		return NULL;
+	}
+	struct zlib_index_header_t header;
+	struct zlib_index_t* index = NULL;
+	if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != INDEX_MAGIC || header.version != INDEX_VERSION
+		|| header.compressed_size != (uint64_t)compressed_size || header.count > SIZE_MAX / sizeof(struct zlib_access_point_t)) {
+		goto done;
+	}
+	index = calloc(1, sizeof(struct zlib_index_t));
+	if (index == NULL) {
+		goto done;
+	}
+	index->points = header.count > 0 ? malloc(header.count * sizeof(struct zlib_access_point_t)) : NULL;
+	if (header.count > 0 && index->points == NULL) {
+		goto fail;
+	}
+	for (index->count = 0; index->count < header.count; index->count++) {
+		struct zlib_access_point_t* point = &index->points[index->count];
+		if (fread(&point->out, sizeof(point->out), 1, file) != 1
+			|| fread(&point->in, sizeof(point->in), 1, file) != 1
+			|| fread(&point->bits, sizeof(point->bits), 1, file) != 1
+			|| fread(&point->window_size, sizeof(point->window_size), 1, file) != 1
+			|| point->bits > 7 || point->window_size > INDEX_WINDOW_SIZE
+			|| fread(point->window, 1, point->window_size, file) != point->window_size) {
+			goto fail;
+		}
+	}
+	goto done;
+
+fail:
+	__free_index(index);
+	index = NULL;
+done:
+	fclose(file);
+	return index;
+}
+
+static bool __write_index(const char* index_path, const struct zlib_index_t* index, int64_t compressed_size)
+{
+	FILE* file = fopen(index_path, "wb");
+	if (file == NULL) {
+		return false;
+	}
+	struct zlib_index_header_t header = { INDEX_MAGIC, INDEX_VERSION, (uint64_t)compressed_size, index->count };
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+	for (size_t i = 0; ok && i < index->count; i++) {
+		const struct zlib_access_point_t* point = &index->points[i];
+		ok = fwrite(&point->out, sizeof(point->out), 1, file) == 1
+			&& fwrite(&point->in, sizeof(point->in), 1, file) == 1
+			&& fwrite(&point->bits, sizeof(point->bits), 1, file) == 1
+			&& fwrite(&point->window_size, sizeof(point->window_size), 1, file) == 1
+			&& fwrite(point->window, 1, point->window_size, file) == point->window_size;
+	}
+	return fclose(file) == 0 && ok;
+}
+
+// Inflates the whole file block by block, keeping an access point every span bytes
+static struct zlib_index_t* __build_index(FILE* file, uint64_t span)
+{
+	struct zlib_index_t* index = calloc(1, sizeof(struct zlib_index_t));
+	uint8_t* buffer_in = malloc(INFLATE_BUFFER_IN_SIZE);
+	uint8_t* buffer_out = malloc(INFLATE_BUFFER_OUT_SIZE);
+	z_stream strm = { 0 };
+	bool ok = index != NULL && buffer_in != NULL && buffer_out != NULL && inflateInit2(&strm, 16 + MAX_WBITS) == Z_OK;
+	bool initialized = ok;
+	size_t capacity = 0;
+	uint64_t read = 0, total_out = 0, last = 0;
+
+	while (ok) {
+		if (strm.avail_in == 0) {
+			strm.avail_in = (uInt)fread(buffer_in, 1, INFLATE_BUFFER_IN_SIZE, file);
+			strm.next_in = buffer_in;
+			read += strm.avail_in;
+			if (strm.avail_in == 0) {
+				break;
+			}
+		}
+		strm.next_out = buffer_out;
+		strm.avail_out = INFLATE_BUFFER_OUT_SIZE;
+		// Z_BLOCK stops at the end of every deflate block, the only places inflating can resume
+		int res = inflate(&strm, Z_BLOCK);
+		total_out += INFLATE_BUFFER_OUT_SIZE - strm.avail_out;
+		if (res == Z_STREAM_END) {
+			if (strm.avail_in == 0) {
+				strm.avail_in = (uInt)fread(buffer_in, 1, INFLATE_BUFFER_IN_SIZE, file);
+				strm.next_in = buffer_in;
+				read += strm.avail_in;
+			}
+			if (strm.avail_in == 0 || strm.next_in[0] != 0x1F) {
+				break;
+			}
+			ok = inflateReset(&strm) == Z_OK;
+			continue;
+		}
+		if (res != Z_OK && res != Z_BUF_ERROR) {
+			ok = false;
+			break;
+		}
+		// Bit 128: end of a block, bit 64: end of the last block of the member, which has no next block to resume at
+		if ((strm.data_type & 128) && !(strm.data_type & 64) && total_out > 0 && (index->count == 0 || total_out - last >= span)) {
+			if (index->count == capacity) {
+				size_t new_capacity = capacity ? capacity * 2 : 8;
+				struct zlib_access_point_t* points = realloc(index->points, new_capacity * sizeof(struct zlib_access_point_t));
+				if (points == NULL) {
+					ok = false;
+					break;
+				}
+				index->points = points;
+				capacity = new_capacity;
+			}
+			struct zlib_access_point_t* point = &index->points[index->count];
+			uInt window_size = INDEX_WINDOW_SIZE;
+			point->out = total_out;
+			point->in = read - strm.avail_in;
+			point->bits = (uint32_t)(strm.data_type & 7);
+			ok = inflateGetDictionary(&strm, point->window, &window_size) == Z_OK;
+			point->window_size = window_size;
+			index->count++;
+			last = total_out;
+		}
+	}
+
+	if (initialized) {
+		inflateEnd(&strm);
+	}
+	free(buffer_in);
+	free(buffer_out);
+	if (!ok) {
+		__free_index(index);
+		return NULL;
+	}
+	return index;
+}
+
+int light_io_zlib_build_index(const char* filename, uint32_t span_mb)
+{
+	int64_t compressed_size = __file_size(filename);
+	FILE* file = fopen(filename, "rb");
+	if (file == NULL || compressed_size < 0) {
+		if (file != NULL) {
+			fclose(file);
+		}
+		return -1;
+	}
+	uint64_t span = (uint64_t)(span_mb ? span_mb : INDEX_DEFAULT_SPAN_MB) * 1024 * 1024;
+	struct zlib_index_t* index = __build_index(file, span);
+	fclose(file);
+	if (index == NULL) {
+		return -1;
+	}
+
+	char* path = __index_path(filename);
+	int res = path != NULL && __write_index(path, index, compressed_size) ? 0 : -1;
+	free(path);
+	__free_index(index);
+	return res;
+}
+
+static int light_zlib_close_inflate(void* context)
+{
+	struct zlib_decompression_t* decompression = context;
+	inflateEnd(&decompression->strm);
+	__free_index(decompression->index);
+	free(decompression->buffer_in);
+	free(decompression->buffer_out);
+	int res = fclose(decompression->file);
+	free(decompression);
+	return res;
+}
+
+// NULL when the file is not gzip compressed, gzread then passes it through as is
+static struct zlib_decompression_t* __open_inflate(const char* filename)
+{
+	FILE* file = fopen(filename, "rb");
+	if (!file) {
+		return NULL;
+	}
+	uint8_t magic[2] = { 0 };
+	if (fread(magic, 1, sizeof(magic), file) != sizeof(magic) || magic[0] != 0x1F || magic[1] != 0x8B
+		|| __file_seek(file, 0, SEEK_SET) != 0) {
+		fclose(file);
+		return NULL;
+	}
+
+	struct zlib_decompression_t* decompression = calloc(1, sizeof(struct zlib_decompression_t));
+	if (decompression == NULL) {
+		fclose(file);
+		return NULL;
+	}
+	decompression->file = file;
+	decompression->buffer_in = malloc(INFLATE_BUFFER_IN_SIZE);
+	decompression->buffer_out = malloc(INFLATE_BUFFER_OUT_SIZE);
+	// 16 + MAX_WBITS: gzip header and trailer
+	if (decompression->buffer_in == NULL || decompression->buffer_out == NULL
+		|| inflateInit2(&decompression->strm, 16 + MAX_WBITS) != Z_OK) {
+		free(decompression->buffer_in);
+		free(decompression->buffer_out);
+		free(decompression);
+		fclose(file);
+		return NULL;
+	}
+
+	// Seeking without the index still works, inflating from the start of the file
+	char* index_path = __index_path(filename);
+	if (index_path != NULL) {
+		decompression->index = __load_index(index_path, __file_size(filename));
+	}
+	free(index_path);
+	return decompression;
+}
+
+// Blocks deflated on workers as independent gzip members, concatenated in order like pigz does
+struct zlib_block_t
+{
+	uint8_t* in;
+	size_t in_size;
+	uint8_t* out;
+	size_t out_size;
+	size_t out_capacity;
+	bool done;
+	bool failed;
+};
+
+struct zlib_parallel_writer_t
+{
+	FILE* file;
+	int level;
+
+	light_mutex mutex;
+	light_cond cond;
+	// Ring of blocks by sequence number: written < compressed < filled
+	struct zlib_block_t* blocks;
+	size_t block_count;
+	uint64_t next_write;
+	uint64_t next_compress;
+	uint64_t next_fill;
+	bool stop;
+	bool failed;
+
+	light_thread* threads;
+	uint32_t worker_count;
+
+	uint64_t position;
+};
+
+static bool __deflate_block(z_stream* strm, struct zlib_block_t* block)
+{
+	size_t bound = deflateBound(strm, (uLong)block->in_size);
+	if (bound > block->out_capacity) {
+		uint8_t* grown = realloc(block->out, bound);
+		if (grown == NULL) {
+			return false;
+		}
+		block->out = grown;
+		block->out_capacity = bound;
+	}
+	strm->next_in = block->in;
+	strm->avail_in = (uInt)block->in_size;
+	strm->next_out = block->out;
+	strm->avail_out = (uInt)block->out_capacity;
+	int res = deflate(strm, Z_FINISH);
+	block->out_size = block->out_capacity - strm->avail_out;
+	return res == Z_STREAM_END && deflateReset(strm) == Z_OK;
+}
+
+static void __deflate_worker(void* arg)
+{
+	struct zlib_parallel_writer_t* writer = arg;
+	z_stream strm = { 0 };
+	// 16 + MAX_WBITS: every block is a whole gzip member
+	bool initialized = deflateInit2(&strm, writer->level, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+
+	light_mutex_lock(&writer->mutex);
+	while (1)
+	{
+		while (!writer->stop && writer->next_compress == writer->next_fill) {
+			light_cond_wait(&writer->cond, &writer->mutex);
+		}
+		if (writer->next_compress == writer->next_fill) {
+			break;
+		}
+		struct zlib_block_t* block = &writer->blocks[writer->next_compress++ % writer->block_count];
+		light_mutex_unlock(&writer->mutex);
+
+		bool ok = initialized && __deflate_block(&strm, block);
+
+		light_mutex_lock(&writer->mutex);
+		block->failed = !ok;
+		block->done = true;
+		light_cond_broadcast(&writer->cond);
+	}
+	light_mutex_unlock(&writer->mutex);
+
+	if (initialized) {
+		deflateEnd(&strm);
+	}
+}
+
+// Writes the deflated blocks in order, until sequence number until. Called with the mutex held.
+static void __write_blocks(struct zlib_parallel_writer_t* writer, uint64_t until)
+{
+	while (writer->next_write < until) {
+		struct zlib_block_t* block = &writer->blocks[writer->next_write % writer->block_count];
+		if (!block->done) {
+			light_cond_wait(&writer->cond, &writer->mutex);
+			continue;
+		}
+		light_mutex_unlock(&writer->mutex);
+		bool ok = !block->failed && fwrite(block->out, 1, block->out_size, writer->file) == block->out_size;
+		light_mutex_lock(&writer->mutex);
+		writer->failed |= !ok;
+		block->done = false;
+		block->in_size = 0;
+		writer->next_write++;
+	}
+}
+
+// Hands the block being filled to the workers, then waits for the next one to be free
+static void __submit_block(struct zlib_parallel_writer_t* writer)
+{
+	light_mutex_lock(&writer->mutex);
+	writer->next_fill++;
+	light_cond_broadcast(&writer->cond);
+	if (writer->next_fill - writer->next_write >= writer->block_count) {
+		__write_blocks(writer, writer->next_fill - writer->block_count + 1);
+	}
+	light_mutex_unlock(&writer->mutex);
+}
+
+static size_t light_zlib_parallel_write(void* context, const void* buf, size_t count)
+{
+	struct zlib_parallel_writer_t* writer = context;
+	const uint8_t* src = buf;
+	size_t done = 0;
+	while (done < count && !writer->failed) {
+		// Only this thread touches the block being filled
+		struct zlib_block_t* block = &writer->blocks[writer->next_fill % writer->block_count];
+		size_t n = count - done < DEFLATE_BLOCK_SIZE - block->in_size ? count - done : DEFLATE_BLOCK_SIZE - block->in_size;
+		memcpy(block->in + block->in_size, src + done, n);
+		block->in_size += n;
+		done += n;
+		if (block->in_size == DEFLATE_BLOCK_SIZE) {
+			__submit_block(writer);
+		}
+	}
+	writer->position += done;
+	return done;
+}
+
+static int64_t light_zlib_parallel_tell(void* context)
+{
+	struct zlib_parallel_writer_t* writer = context;
+	return (int64_t)writer->position;
+}
+
+static int light_zlib_parallel_flush(void* context)
+{
+	struct zlib_parallel_writer_t* writer = context;
+	// A partial block ends a member early, which costs some compression but keeps the file whole
+	if (writer->blocks[writer->next_fill % writer->block_count].in_size > 0) {
+		__submit_block(writer);
+	}
+	light_mutex_lock(&writer->mutex);
+	__write_blocks(writer, writer->next_fill);
+	bool failed = writer->failed;
+	light_mutex_unlock(&writer->mutex);
+	return fflush(writer->file) != 0 || failed ? -1 : 0;
+}
+
+static void __free_parallel_writer(struct zlib_parallel_writer_t* writer)
+{
+	light_mutex_lock(&writer->mutex);
+	writer->stop = true;
+	light_cond_broadcast(&writer->cond);
+	light_mutex_unlock(&writer->mutex);
+	for (uint32_t i = 0; i < writer->worker_count; i++) {
+		light_thread_join(writer->threads[i]);
+	}
+	for (size_t i = 0; writer->blocks != NULL && i < writer->block_count; i++) {
+		free(writer->blocks[i].in);
+		free(writer->blocks[i].out);
+	}
+	free(writer->blocks);
+	free(writer->threads);
+	light_cond_destroy(&writer->cond);
+	light_mutex_destroy(&writer->mutex);
+	free(writer);
+}
+
+static int light_zlib_parallel_close(void* context)
+{
+	struct zlib_parallel_writer_t* writer = context;
+	// Nothing written still makes a valid gzip file, of one empty member
+	if (writer->next_fill == 0) {
+		__submit_block(writer);
+	}
+	int res = light_zlib_parallel_flush(writer);
+	FILE* file = writer->file;
+	__free_parallel_writer(writer);
+	return fclose(file) != 0 ? -1 : res;
+}
+
+static struct zlib_parallel_writer_t* __open_parallel_writer(FILE* file, int level, uint32_t worker_count)
+{
+	struct zlib_parallel_writer_t* writer = calloc(1, sizeof(struct zlib_parallel_writer_t));
+	if (writer == NULL) {
+		return NULL;
+	}
+	writer->file = file;
+	writer->level = level;
+	light_mutex_init(&writer->mutex);
+	light_cond_init(&writer->cond);
+	// Two blocks per worker keep them busy while the previous ones are written
+	writer->block_count = 2 * (size_t)worker_count;
+	writer->blocks = calloc(writer->block_count, sizeof(struct zlib_block_t));
+	writer->threads = calloc(worker_count, sizeof(light_thread));
+	bool ok = writer->blocks != NULL && writer->threads != NULL;
+	for (size_t i = 0; ok && i < writer->block_count; i++) {
+		writer->blocks[i].in = malloc(DEFLATE_BLOCK_SIZE);
+		ok = writer->blocks[i].in != NULL;
+	}
+	while (ok && writer->worker_count < worker_count) {
+		ok = light_thread_create(&writer->threads[writer->worker_count], __deflate_worker, writer) == 0;
+		writer->worker_count += ok;
+	}
+	if (!ok) {
+		__free_parallel_writer(writer);
+		return NULL;
+	}
+	return writer;
+}
+
+static light_file __open_inflate_file(struct zlib_decompression_t* decompression)
+{
+	light_file fd = calloc(1, sizeof(struct light_file_t));
+	fd->context = decompression;
+	fd->fn_read = &light_zlib_read_inflate;
+	fd->fn_seek = &light_zlib_seek_inflate;
+	fd->fn_tell = &light_zlib_tell_inflate;
+	fd->fn_close = &light_zlib_close_inflate;
+	return fd;
+}
+
 light_file light_io_zlib_open(const char* filename, const char* mode)
 {
-	gzFile file = gzopen(filename, mode);
+	if (mode && strchr(mode, 'r') && !strchr(mode, '+')) {
+		struct zlib_decompression_t* decompression = __open_inflate(filename);
+		if (decompression) {
+			return __open_inflate_file(decompression);
+		}
+	}
+
+	// ",N" writes on N workers, gzopen would take the digits for the level
+	char gz_mode[16] = { 0 };
+	size_t gz_mode_length = 0;
+	uint32_t worker_count = 0;
+	int level = Z_DEFAULT_COMPRESSION;
+	bool write = false;
+	bool append = false;
+	bool read = false;
+	for (const char* m = mode; m && *m; m++) {
+		if (*m == ',') {
+			worker_count = 0;
+			while (m[1] >= '0' && m[1] <= '9') {
+				worker_count = worker_count < 1024 ? worker_count * 10 + (uint32_t)(m[1] - '0') : worker_count;
+				m++;
+			}
+			continue;
+		}
+		if (*m >= '0' && *m <= '9') {
+			level = *m - '0';
+		}
+		write |= *m == 'w';
+		append |= *m == 'a';
+		read |= *m == 'r' || *m == '+';
+		if (gz_mode_length < sizeof(gz_mode) - 1) {
+			gz_mode[gz_mode_length++] = *m;
+		}
+	}
+
+	if (worker_count > 1 && (write || append) && !read) {
+		// Members concatenate, so appending is just more of them at the end
+		FILE* file = fopen(filename, append ? "ab" : "wb");
+		if (!file) {
+			return NULL;
+		}
+		struct zlib_parallel_writer_t* writer = __open_parallel_writer(file, level, worker_count);
+		if (!writer) {
+			fclose(file);
+			return NULL;
+		}
+		light_file fd = calloc(1, sizeof(struct light_file_t));
+		fd->context = writer;
+		fd->fn_write = &light_zlib_parallel_write;
+		fd->fn_flush = &light_zlib_parallel_flush;
+		fd->fn_tell = &light_zlib_parallel_tell;
+		fd->fn_close = &light_zlib_parallel_close;
+		return fd;
+	}
+
+	gzFile file = gzopen(filename, gz_mode);
 	if (!file)
 	{
 		return NULL;
 	}
-	light_file fd = malloc(sizeof(struct light_file_t));
+	light_file fd = calloc(1, sizeof(struct light_file_t));
 
 	fd->context = file;
 	fd->fn_read = &light_zlib_read;
 	fd->fn_write = &light_zlib_write;
 	fd->fn_flush = &light_zlib_flush;
 	fd->fn_seek = &light_zlib_seek;
+	fd->fn_tell = &light_zlib_tell;
 	fd->fn_close = &light_zlib_close;
 
 	return fd;
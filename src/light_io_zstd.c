@@ -24,6 +24,7 @@
 #include "light_io.h"
 #include "light_io_internal.h"
 #include "light_io_zstd.h"
+#include "light_thread.h"
 #include <stdlib.h>
 #include <stdint.h>
 #include <stdbool.h>
@@ -38,6 +39,42 @@
 #define COMPRESSION_BUFFER_IN_MAX_SIZE 2048
 
 #define MAX(a,b) (((a)>(b))?(a):(b))
+#define MIN(a,b) (((a)<(b))?(a):(b))
+
+// Reads of at least this many bytes are decompressed straight into the caller's buffer
+#define DECOMPRESSION_DIRECT_MIN_SIZE 4096
+
+// Frames end after this many uncompressed bytes unless the mode string says otherwise
+#define DEFAULT_FRAME_SIZE_MB 4
+// Frame sizes are stored as 32 bit in the seek table
+#define MAX_FRAME_SIZE_MB 1024
+
+// Seek table of the zstd seekable format: a skippable frame holding the compressed and
+// decompressed size of every frame, followed by a footer
+#define SEEKABLE_SKIPPABLE_MAGIC 0x184D2A5E
+#define SEEKABLE_MAGIC 0x8F92EAB1
+#define SEEKABLE_FOOTER_SIZE 9
+#define SEEKABLE_ENTRY_SIZE 8
+#define SEEKABLE_CHECKSUM_FLAG 0x80
+#define SEEKABLE_RESERVED_BITS 0x7C
+
+// Magic, descriptor, window, dictionary id and content size at their largest
+#define FRAME_HEADER_MAX_SIZE 18
+
+// Where a frame starts, in the file and in the decompressed capture
+struct zstd_seek_point_t
+{
+	uint64_t compressed;
+	uint64_t decompressed;
+};
+
+// points[i] is the start of frame i, points[count] the end of the last frame
+struct zstd_seek_table_t
+{
+	struct zstd_seek_point_t* points;
+	size_t count;
+	size_t capacity;
+};
 
 //This is the z-std compression type I would call it z-std type and realias 
 //2x but complier won't let me do that across bounds it seems
@@ -53,6 +90,13 @@ struct zstd_compression_t
 	size_t buffer_out_max_size;
 
 	ZSTD_CCtx* cctx;
+
+	// Frames are ended every frame_size uncompressed bytes, 0 for a single frame
+	bool seekable;
+	uint64_t frame_size;
+	uint64_t frame_in;
+	uint64_t frame_out;
+	struct zstd_seek_table_t table;
 };
 
 struct zstd_decompression_t
@@ -65,12 +109,153 @@ struct zstd_decompression_t
 	size_t buffer_out_max_size;
 
 	ZSTD_DCtx* dctx;
-	int outputReady;
 
 	ZSTD_outBuffer output;
 	ZSTD_inBuffer input;
+
+	// Decompressed bytes handed out so far
+	uint64_t position;
+	// Empty when the file has no seek table, seeks then start over from the first frame
+	struct zstd_seek_table_t table;
+	// Where the frames end and the seek table starts
+	uint64_t frames_end;
 };
 
+// Reads through the decompression until the first write, which goes after the last frame
+struct zstd_append_t
+{
+	struct zstd_decompression_t* decompression;
+	struct zstd_compression_t* compression;
+	bool writing;
+};
+
+static int64_t __file_seek(FILE* file, int64_t offset, int origin)
+{
+#if _WIN32
+	return _fseeki64(file, offset, origin);
+#elif (HAVE_FSEEKO64 + 0)
+	return fseeko64(file, offset, origin);
+#else
+	return fseek(file, offset, origin);
+#endif
+}
+
+static int64_t __file_tell(FILE* file)
+{
+#if _WIN32
+	return _ftelli64(file);
+#elif (HAVE_FSEEKO64 + 0)
+	return ftello64(file);
+#else
+	return ftell(file);
+#endif
+}
+
+static uint32_t __read_le32(const uint8_t* data)
+{
+	return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static void __write_le32(uint8_t* data, uint32_t value)
+{
+	data[0] = (uint8_t)value;
+	data[1] = (uint8_t)(value >> 8);
+	data[2] = (uint8_t)(value >> 16);
+	data[3] = (uint8_t)(value >> 24);
+}
+
+static bool __seek_table_push(struct zstd_seek_table_t* table, uint64_t compressed_size, uint64_t decompressed_size)
+{
+	if (table->count + 2 > table->capacity) {
+		size_t capacity = MAX(2 * table->capacity, 64);
+		struct zstd_seek_point_t* points = realloc(table->points, capacity * sizeof(struct zstd_seek_point_t));
+		if (points == NULL) {
+			return false;
+		}
+		if (table->capacity == 0) {
+			points[0].compressed = 0;
+			points[0].decompressed = 0;
+		}
+		table->points = points;
+		table->capacity = capacity;
+	}
+	struct zstd_seek_point_t end = table->points[table->count];
+	table->count++;
+	table->points[table->count].compressed = end.compressed + compressed_size;
+	table->points[table->count].decompressed = end.decompressed + decompressed_size;
+	return true;
+}
+
+// Loads the seek table at the end of the file, frames_end is the file size when there is none
+static bool __seek_table_read(FILE* file, struct zstd_seek_table_t* table, uint64_t* frames_end)
+{
+	int64_t size = __file_seek(file, 0, SEEK_END) == 0 ? __file_tell(file) : -1;
+	*frames_end = size > 0 ? (uint64_t)size : 0;
+
+	uint8_t footer[SEEKABLE_FOOTER_SIZE];
+	if (size < 8 + SEEKABLE_FOOTER_SIZE
+		|| __file_seek(file, size - SEEKABLE_FOOTER_SIZE, SEEK_SET) != 0
+		|| fread(footer, 1, sizeof(footer), file) != sizeof(footer)
+		|| __read_le32(footer + 5) != SEEKABLE_MAGIC
+		|| (footer[4] & SEEKABLE_RESERVED_BITS) != 0) {
+		return false;
+	}
+	uint64_t frames = __read_le32(footer);
+	uint64_t entry_size = SEEKABLE_ENTRY_SIZE + ((footer[4] & SEEKABLE_CHECKSUM_FLAG) ? 4 : 0);
+	uint64_t table_size = 8 + frames * entry_size + SEEKABLE_FOOTER_SIZE;
+	if (table_size > (uint64_t)size) {
+		return false;
+	}
+
+	uint8_t header[8];
+	uint8_t* entries = malloc((size_t)(frames * entry_size) + 1);
+	bool valid = entries != NULL
+		&& __file_seek(file, size - (int64_t)table_size, SEEK_SET) == 0
+		&& fread(header, 1, sizeof(header), file) == sizeof(header)
+		&& __read_le32(header) == SEEKABLE_SKIPPABLE_MAGIC
+		&& __read_le32(header + 4) == table_size - 8
+		&& fread(entries, 1, (size_t)(frames * entry_size), file) == frames * entry_size;
+
+	for (uint64_t i = 0; valid && i < frames; i++) {
+		const uint8_t* entry = entries + i * entry_size;
+		valid = __seek_table_push(table, __read_le32(entry), __read_le32(entry + 4));
+	}
+	free(entries);
+
+	uint64_t end = table->count > 0 ? table->points[table->count].compressed : 0;
+	if (!valid || end != (uint64_t)size - table_size) {
+		free(table->points);
+		memset(table, 0, sizeof(*table));
+		return false;
+	}
+	*frames_end = (uint64_t)size - table_size;
+	return true;
+}
+
+static bool __seek_table_write(FILE* file, const struct zstd_seek_table_t* table)
+{
+	size_t table_size = 8 + table->count * SEEKABLE_ENTRY_SIZE + SEEKABLE_FOOTER_SIZE;
+	uint8_t* data = malloc(table_size);
+	if (data == NULL) {
+		return false;
+	}
+	__write_le32(data, SEEKABLE_SKIPPABLE_MAGIC);
+	__write_le32(data + 4, (uint32_t)(table_size - 8));
+	uint8_t* entry = data + 8;
+	for (size_t i = 0; i < table->count; i++) {
+		__write_le32(entry, (uint32_t)(table->points[i + 1].compressed - table->points[i].compressed));
+		__write_le32(entry + 4, (uint32_t)(table->points[i + 1].decompressed - table->points[i].decompressed));
+		entry += SEEKABLE_ENTRY_SIZE;
+	}
+	__write_le32(entry, (uint32_t)table->count);
+	entry[4] = 0;
+	__write_le32(entry + 5, SEEKABLE_MAGIC);
+
+	bool res = fwrite(data, 1, table_size, file) == table_size;
+	free(data);
+	return res;
+}
+
 void* get_zstd_compression_context(FILE* file, int compression_level, int num_workers)
 {
 	struct zstd_compression_t* context = calloc(1, sizeof(struct zstd_compression_t));
@@ -116,94 +301,164 @@ void* get_zstd_decompression_context(FILE* file)
 	context->buffer_out_max_size = MAX(ZSTD_DStreamOutSize(), COMPRESSION_BUFFER_IN_MAX_SIZE);
 	context->buffer_out = malloc(context->buffer_out_max_size);
 
+	// Nothing staged yet
 	context->output.dst = context->buffer_out;
-	context->output.size = context->buffer_out_max_size;
+	context->output.size = 0;
 	context->output.pos = 0;
-	context->outputReady = 0;
+
+	// The seek table, if any, then back to the first frame
+	__seek_table_read(file, &context->table, &context->frames_end);
+	__file_seek(file, 0, SEEK_SET);
 
 	return context;
 }
 
+// Decompresses at most size bytes into dst, 0 once the input is over
+static size_t __zstd_decompress(struct zstd_decompression_t* decompression, void* dst, size_t size)
+{
+	ZSTD_outBuffer output = { dst, size, 0 };
+	while (output.pos == 0)
+	{
+		//Check if we need to grab a new chunk from the actual file
+		if (decompression->input.pos >= decompression->input.size)
+		{
+			decompression->input.src = decompression->buffer_in;
+			decompression->input.size = fread(decompression->buffer_in, 1, decompression->buffer_in_max_size, decompression->file);
+			decompression->input.pos = 0;
+		}
+		size_t const remaining = ZSTD_decompressStream(decompression->dctx, &output, &decompression->input);
+		// Nothing left to read and nothing flushed from the context either
+		if (ZSTD_isError(remaining) || (output.pos == 0 && decompression->input.size == 0))
+			break;
+	}
+	return output.pos;
+}
+
 size_t light_zstd_read(void* context, void* buf, size_t count)
 {
 	struct zstd_decompression_t* decompression = context;
-	//Decompression is a little more complex
-	//Need to manage reading bytes from orignal file
-	//Decompressing those into a buffer
-	//Then reading the selected number of bytes from the buffer
-	//Once whole buffer is consumed we need to read and decompress next chunk from file
+	//Small reads (block headers) are served from a staging buffer,
+	//large ones (block bodies) are decompressed straight into buf
 
 	size_t bytes_read = 0;
 
 	while (bytes_read < count)
 	{
-		if (decompression->outputReady == 0)
+		//What is left of the staging buffer goes first
+		size_t remaining = decompression->output.size - decompression->output.pos;
+		if (remaining > 0)
 		{
-			//Check if we need to grab a new chunk from the actual file
-			//If we read all the input then yes, we need to do that
-			if (decompression->input.pos >= decompression->input.size)
-			{
-				//Read a decompress a chunk
-				size_t bytes_read_file = fread(decompression->buffer_in, 1, decompression->buffer_in_max_size, decompression->file);
-				if (bytes_read_file < decompression->buffer_in_max_size && bytes_read_file == 0 && feof(decompression->file))
-					return EOF;
-				decompression->input.src = decompression->buffer_in;
-				decompression->input.size = bytes_read_file;
-				decompression->input.pos = 0;
-			}
-			//Decompress into the output buffer and use this buffer to actually get our results
-			decompression->output.dst = decompression->buffer_out;
-			decompression->output.size = decompression->buffer_out_max_size;
-			decompression->output.pos = 0;
-
-			size_t const remaining = ZSTD_decompressStream(decompression->dctx, &decompression->output, &decompression->input);
-			assert(!ZSTD_isError(remaining));
+			size_t needToRead = MIN(count - bytes_read, remaining);
+			memcpy((uint8_t*)buf + bytes_read, (uint8_t*)decompression->output.dst + decompression->output.pos, needToRead);
+			decompression->output.pos += needToRead;
+			bytes_read += needToRead;
+			continue;
+		}
 
+		if (count - bytes_read >= DECOMPRESSION_DIRECT_MIN_SIZE)
+		{
+			size_t produced = __zstd_decompress(decompression, (uint8_t*)buf + bytes_read, count - bytes_read);
+			if (produced == 0)
+				break;
+			bytes_read += produced;
+		}
+		else
+		{
 			//Re-use the output class to track our own consumption
-			decompression->output.size = decompression->output.pos;
+			decompression->output.size = __zstd_decompress(decompression, decompression->buffer_out, decompression->buffer_out_max_size);
 			decompression->output.pos = 0;
-			decompression->outputReady = 1;
+			if (decompression->output.size == 0)
+				break;
 		}
+	}
 
-		//Now get bytes from our output buffer
+	decompression->position += bytes_read;
+	return bytes_read;
+}
 
-		//Case we need everything or less than that which was decoded
-		size_t needToRead = count - bytes_read;
-		size_t remaining = (decompression->output.size - decompression->output.pos);
-		if (needToRead <= remaining)
-		{
-			memcpy((uint8_t*)buf + bytes_read, (uint8_t*)decompression->output.dst + decompression->output.pos, needToRead);
-			decompression->output.pos += needToRead;
-			bytes_read += needToRead;
+int64_t light_zstd_seek(void* context, int64_t offset, int origin)
+{
+	struct zstd_decompression_t* decompression = context;
+	const struct zstd_seek_table_t* table = &decompression->table;
+
+	if (origin == SEEK_CUR) {
+		offset += (int64_t)decompression->position;
+	}
+	else if (origin == SEEK_END) {
+		if (table->count == 0) {
+			return -1;
 		}
+		offset += (int64_t)table->points[table->count].decompressed;
+	}
+	if (offset < 0) {
+		return -1;
+	}
+	uint64_t target = (uint64_t)offset;
 
-		//Case we need more than that which was decoded
-		if (needToRead > remaining)
-		{
-			memcpy((uint8_t*)buf + bytes_read, (uint8_t*)decompression->output.dst + decompression->output.pos, remaining);
-			bytes_read += remaining;
-			decompression->output.pos += remaining;
+	// Last frame starting at or before the target, found by bisection
+	size_t frame = 0;
+	if (table->count > 0) {
+		size_t low = 0, high = table->count;
+		while (high - low > 1) {
+			size_t middle = low + (high - low) / 2;
+			if (table->points[middle].decompressed <= target) {
+				low = middle;
+			}
+			else {
+				high = middle;
+			}
 		}
+		frame = low;
+	}
+	struct zstd_seek_point_t start = { 0, 0 };
+	if (table->count > 0) {
+		start = table->points[frame];
+	}
 
-		//We have consumed everything - set next call to decompress a new chunk
-		if (decompression->output.pos == decompression->output.size)
-			decompression->outputReady = 0;
+	// Only frames before the target are skipped, by jumping to the one holding it
+	if (target < decompression->position || decompression->position < start.decompressed)
+	{
+		if (__file_seek(decompression->file, (int64_t)start.compressed, SEEK_SET) != 0) {
+			return -1;
+		}
+		ZSTD_DCtx_reset(decompression->dctx, ZSTD_reset_session_only);
+		decompression->input.size = 0;
+		decompression->input.pos = 0;
+		decompression->output.size = 0;
+		decompression->output.pos = 0;
+		decompression->position = start.decompressed;
+	}
 
+	// Then decompressed up to the target within the frame
+	while (decompression->position < target)
+	{
+		size_t remaining = decompression->output.size - decompression->output.pos;
+		if (remaining == 0)
+		{
+			decompression->output.size = __zstd_decompress(decompression, decompression->buffer_out, decompression->buffer_out_max_size);
+			decompression->output.pos = 0;
+			if (decompression->output.size == 0)
+				return -1;
+			continue;
+		}
+		size_t skip = (size_t)MIN((uint64_t)remaining, target - decompression->position);
+		decompression->output.pos += skip;
+		decompression->position += skip;
 	}
 
-	return bytes_read;
+	return (int64_t)decompression->position;
 }
 
-size_t light_zstd_write(void* context, const void* buf, size_t count)
+int64_t light_zstd_tell(void* context)
 {
-	struct zstd_compression_t* compression = context;
-	// Do compression here!
-	/* Set the input buffer to what we just read.
-	* We compress until the input buffer is empty, each time flushing the
-	* output.
-	*/
-	ZSTD_inBuffer input = { buf, count, 0 };
-	int finished;
+	struct zstd_decompression_t* decompression = context;
+	return (int64_t)decompression->position;
+}
+
+// Compresses the input with the given directive, writing out everything produced
+static bool __zstd_compress(struct zstd_compression_t* compression, ZSTD_inBuffer* input, ZSTD_EndDirective directive)
+{
+	size_t remaining;
 	do
 	{
 		/* Compress into the output buffer and write all of the output to
@@ -214,66 +469,575 @@ size_t light_zstd_write(void* context, const void* buf, size_t count)
 			compression->buffer_out_max_size,
 			0
 		};
-		size_t const remaining = ZSTD_compressStream2(compression->cctx, &output, &input, ZSTD_e_continue);
-		assert(!ZSTD_isError(remaining));
-		fwrite(output.dst, 1, output.pos, compression->file);
-		// If we're on the last chunk we're finished when zstd returns 0,
-		// We're finished when we've consumed all the input.
-		finished = (input.pos == input.size);
-	} while (!finished);
+		remaining = ZSTD_compressStream2(compression->cctx, &output, input, directive);
+		if (ZSTD_isError(remaining))
+			return false;
+		if (fwrite(output.dst, 1, output.pos, compression->file) != output.pos)
+			return false;
+		compression->frame_out += output.pos;
+		// Continuing is done once the input is consumed, ending once zstd has flushed everything
+	} while (directive == ZSTD_e_continue ? input->pos < input->size : remaining != 0);
 
-	return count;
+	return true;
 }
 
-int light_zstd_close_w(void* context)
+// Ends the current frame and records it in the seek table
+static bool __zstd_end_frame(struct zstd_compression_t* compression)
 {
-	struct zstd_compression_t* compression = context;
-	//Wrap up the compression here
+	if (compression->frame_in == 0)
+		return true;
 
-	ZSTD_inBuffer input = { 0,0,0 };
+	ZSTD_inBuffer input = { NULL, 0, 0 };
+	if (!__zstd_compress(compression, &input, ZSTD_e_end))
+		return false;
+	if (compression->seekable && !__seek_table_push(&compression->table, compression->frame_out, compression->frame_in))
+		return false;
 
-	int remaining = 1;
+	compression->frame_in = 0;
+	compression->frame_out = 0;
+	return true;
+}
+
+size_t light_zstd_write(void* context, const void* buf, size_t count)
+{
+	struct zstd_compression_t* compression = context;
+	const uint8_t* data = buf;
+	size_t written = 0;
 
-	while (remaining != 0)
+	while (written < count)
 	{
-		ZSTD_outBuffer output = { compression->buffer_out, compression->buffer_out_max_size, 0 };
-		remaining = ZSTD_compressStream2(compression->cctx, &output, &input, ZSTD_e_end);
-		fwrite(output.dst, 1, output.pos, compression->file);
+		// Frames are cut exactly every frame_size bytes
+		size_t take = count - written;
+		if (compression->frame_size > 0)
+			take = (size_t)MIN((uint64_t)take, compression->frame_size - compression->frame_in);
+
+		ZSTD_inBuffer input = { data + written, take, 0 };
+		if (!__zstd_compress(compression, &input, ZSTD_e_continue))
+			break;
+		compression->frame_in += take;
+		written += take;
+
+		if (compression->frame_size > 0 && compression->frame_in == compression->frame_size && !__zstd_end_frame(compression))
+			break;
 	}
 
+	return written;
+}
+
+static void __free_compression(struct zstd_compression_t* compression)
+{
 	ZSTD_freeCCtx(compression->cctx);
 	free(compression->buffer_out);
 	free(compression->buffer_in);
+	free(compression->table.points);
+	free(compression);
+}
+
+static void __free_decompression(struct zstd_decompression_t* decompression)
+{
+	ZSTD_freeDCtx(decompression->dctx);
+	free(decompression->buffer_out);
+	free(decompression->buffer_in);
+	free(decompression->table.points);
+	free(decompression);
+}
+
+// Wraps up the last frame and the seek table, the file stays open
+static bool __finish_compression(struct zstd_compression_t* compression)
+{
+	if (compression->seekable)
+	{
+		return __zstd_end_frame(compression) && __seek_table_write(compression->file, &compression->table);
+	}
+
+	// A single frame, ended even when empty
+	ZSTD_inBuffer input = { NULL, 0, 0 };
+	return __zstd_compress(compression, &input, ZSTD_e_end);
+}
+
+int light_zstd_close_w(void* context)
+{
+	struct zstd_compression_t* compression = context;
+	//Wrap up the compression here
+	bool finished = __finish_compression(compression);
 
 	int res = fclose(compression->file);
-	free(compression);
+	__free_compression(compression);
 
-	return res;
+	return finished ? res : EOF;
 }
 
 int light_zstd_close_r(void* context)
 {
 	struct zstd_decompression_t* decompression = context;
 
-	ZSTD_freeDCtx(decompression->dctx);
-	free(decompression->buffer_out);
-	free(decompression->buffer_in);
-
 	int res = fclose(decompression->file);
-	free(decompression);
+	__free_decompression(decompression);
+
+	return res;
+}
+
+static size_t light_zstd_append_read(void* context, void* buf, size_t count)
+{
+	struct zstd_append_t* append = context;
+	if (append->writing) {
+		// Nothing is read back from frames being written
+		return 0;
+	}
+	return light_zstd_read(append->decompression, buf, count);
+}
+
+static size_t light_zstd_append_write(void* context, const void* buf, size_t count)
+{
+	struct zstd_append_t* append = context;
+	if (!append->writing)
+	{
+		// New frames go over the old seek table, the new one is longer and written on close
+		if (__file_seek(append->compression->file, (int64_t)append->decompression->frames_end, SEEK_SET) != 0)
+			return 0;
+		append->writing = true;
+	}
+	return light_zstd_write(append->compression, buf, count);
+}
+
+static int64_t light_zstd_append_seek(void* context, int64_t offset, int origin)
+{
+	struct zstd_append_t* append = context;
+	if (append->writing) {
+		return -1;
+	}
+	return light_zstd_seek(append->decompression, offset, origin);
+}
+
+static int64_t light_zstd_append_tell(void* context)
+{
+	struct zstd_append_t* append = context;
+	if (append->writing) {
+		return -1;
+	}
+	return light_zstd_tell(append->decompression);
+}
+
+static int light_zstd_append_close(void* context)
+{
+	struct zstd_append_t* append = context;
+	// The file is left untouched unless something was written
+	bool finished = !append->writing || __finish_compression(append->compression);
+
+	int res = fclose(append->compression->file);
+	__free_compression(append->compression);
+	__free_decompression(append->decompression);
+	free(append);
+
+	return finished ? res : EOF;
+}
+
+// A frame of the parallel reader, decompressed_offset is UINT64_MAX when unknown
+struct zstd_frame_t
+{
+	uint64_t offset;
+	uint64_t compressed_size;
+	uint64_t decompressed_offset;
+};
+
+enum zstd_slot_state { ZSTD_SLOT_FREE, ZSTD_SLOT_BUSY, ZSTD_SLOT_READY, ZSTD_SLOT_FAILED };
+
+// Decompressed frame waiting to be read, frame f goes to slot f % slot_count
+struct zstd_slot_t
+{
+	enum zstd_slot_state state;
+	uint8_t* data;
+	size_t size;
+	size_t capacity;
+};
+
+// Frames are decompressed ahead on workers and read in order, at most slot_count frames ahead
+struct zstd_parallel_t
+{
+	FILE* file;
+	// Compressed reads from the workers take turns on the file
+	light_mutex file_mutex;
+
+	struct zstd_frame_t* frames;
+	size_t frame_count;
+
+	light_mutex mutex;
+	light_cond cond;
+	struct zstd_slot_t* slots;
+	size_t slot_count;
+	// Next frame for a worker to take, and the frame being read
+	size_t next_frame;
+	size_t read_frame;
+	size_t read_pos;
+	bool stop;
+
+	light_thread* threads;
+	uint32_t worker_count;
+	bool running;
+
+	uint64_t position;
+	// Decompressed size, UINT64_MAX when some frame does not tell its size
+	uint64_t size;
+};
+
+// Frames of a file without seek table, walking frame and block headers without decompressing
+static bool __scan_frames(FILE* file, struct zstd_frame_t** frames, size_t* frame_count, uint64_t* decompressed_size)
+{
+	int64_t size = __file_seek(file, 0, SEEK_END) == 0 ? __file_tell(file) : -1;
+	uint64_t offset = 0;
+	uint64_t decompressed = 0;
+	size_t capacity = 0;
+	*frames = NULL;
+	*frame_count = 0;
+
+	while (size > 0 && offset < (uint64_t)size)
+	{
+		uint8_t header[FRAME_HEADER_MAX_SIZE];
+		size_t available;
+		if (__file_seek(file, (int64_t)offset, SEEK_SET) != 0
+			|| (available = fread(header, 1, sizeof(header), file)) < 8)
+			return false;
+
+		uint32_t magic = __read_le32(header);
+		if ((magic & 0xFFFFFFF0) == 0x184D2A50) {
+			// Skippable frames, seek tables among them, hold no capture data
+			offset += 8 + (uint64_t)__read_le32(header + 4);
+			continue;
+		}
+		if (magic != ZSTD_MAGICNUMBER)
+			return false;
+
+		// Frame header descriptor, see RFC 8878 section 3.1.1.1
+		uint8_t descriptor = header[4];
+		bool single_segment = (descriptor >> 5) & 1;
+		bool checksum = (descriptor >> 2) & 1;
+		static const size_t dictionary_sizes[4] = { 0, 1, 2, 4 };
+		size_t content_size_bytes = (descriptor >> 6) == 0 ? (single_segment ? 1 : 0) : ((size_t)1 << (descriptor >> 6));
+		size_t header_size = 5 + (single_segment ? 0 : 1) + dictionary_sizes[descriptor & 3] + content_size_bytes;
+		unsigned long long content_size = ZSTD_getFrameContentSize(header, available);
+
+		uint64_t end = offset + header_size;
+		bool last = false;
+		while (!last) {
+			uint8_t block[3];
+			if (__file_seek(file, (int64_t)end, SEEK_SET) != 0 || fread(block, 1, sizeof(block), file) != sizeof(block))
+				return false;
+			uint32_t block_header = block[0] | ((uint32_t)block[1] << 8) | ((uint32_t)block[2] << 16);
+			uint32_t type = (block_header >> 1) & 3;
+			last = block_header & 1;
+			if (type == 3)
+				return false;
+			// RLE blocks store their byte once
+			end += 3 + (type == 1 ? 1 : block_header >> 3);
+		}
+		end += checksum ? 4 : 0;
+
+		if (*frame_count == capacity) {
+			capacity = MAX(2 * capacity, 64);
+			struct zstd_frame_t* grown = realloc(*frames, capacity * sizeof(struct zstd_frame_t));
+			if (grown == NULL)
+				return false;
+			*frames = grown;
+		}
+		struct zstd_frame_t* frame = &(*frames)[(*frame_count)++];
+		frame->offset = offset;
+		frame->compressed_size = end - offset;
+		frame->decompressed_offset = decompressed;
+		// Once a size is unknown, so are the offsets of the frames after it
+		decompressed = (decompressed == UINT64_MAX || content_size >= ZSTD_CONTENTSIZE_ERROR) ? UINT64_MAX : decompressed + content_size;
+		offset = end;
+	}
+	*decompressed_size = decompressed;
+	return true;
+}
+
+// Decompresses one whole frame into the slot
+static bool __decompress_frame(struct zstd_parallel_t* parallel, ZSTD_DCtx* dctx, uint8_t** input, size_t* input_capacity,
+	const struct zstd_frame_t* frame, struct zstd_slot_t* slot)
+{
+	if (frame->compressed_size > *input_capacity) {
+		uint8_t* grown = realloc(*input, (size_t)frame->compressed_size);
+		if (grown == NULL)
+			return false;
+		*input = grown;
+		*input_capacity = (size_t)frame->compressed_size;
+	}
+	light_mutex_lock(&parallel->file_mutex);
+	bool loaded = __file_seek(parallel->file, (int64_t)frame->offset, SEEK_SET) == 0
+		&& fread(*input, 1, (size_t)frame->compressed_size, parallel->file) == frame->compressed_size;
+	light_mutex_unlock(&parallel->file_mutex);
+	if (!loaded)
+		return false;
+
+	unsigned long long content_size = ZSTD_getFrameContentSize(*input, (size_t)frame->compressed_size);
+	size_t wanted = content_size < ZSTD_CONTENTSIZE_ERROR ? (size_t)content_size : 4 * (size_t)frame->compressed_size;
+	ZSTD_inBuffer in = { *input, (size_t)frame->compressed_size, 0 };
+	slot->size = 0;
+	ZSTD_DCtx_reset(dctx, ZSTD_reset_session_only);
+	while (1)
+	{
+		if (slot->capacity < MAX(wanted, 1024) || slot->size == slot->capacity) {
+			size_t capacity = MAX(MAX(wanted, 1024), 2 * slot->capacity);
+			uint8_t* grown = realloc(slot->data, capacity);
+			if (grown == NULL)
+				return false;
+			slot->data = grown;
+			slot->capacity = capacity;
+		}
+		ZSTD_outBuffer out = { slot->data, slot->capacity, slot->size };
+		size_t const remaining = ZSTD_decompressStream(dctx, &out, &in);
+		slot->size = out.pos;
+		if (ZSTD_isError(remaining))
+			return false;
+		if (remaining == 0)
+			return true;
+		if (in.pos == in.size && out.pos < out.size)
+			return false; // truncated frame
+	}
+}
+
+static void __zstd_worker(void* arg)
+{
+	struct zstd_parallel_t* parallel = arg;
+	ZSTD_DCtx* dctx = ZSTD_createDCtx();
+	uint8_t* input = NULL;
+	size_t input_capacity = 0;
 
+	light_mutex_lock(&parallel->mutex);
+	while (1)
+	{
+		// The slot of the next frame is free once the frame slot_count before it was read
+		while (!parallel->stop && parallel->next_frame < parallel->frame_count
+			&& parallel->next_frame >= parallel->read_frame + parallel->slot_count)
+			light_cond_wait(&parallel->cond, &parallel->mutex);
+		if (parallel->stop || parallel->next_frame >= parallel->frame_count)
+			break;
+
+		size_t index = parallel->next_frame++;
+		struct zstd_slot_t* slot = &parallel->slots[index % parallel->slot_count];
+		slot->state = ZSTD_SLOT_BUSY;
+		light_mutex_unlock(&parallel->mutex);
+
+		bool done = dctx != NULL && __decompress_frame(parallel, dctx, &input, &input_capacity, &parallel->frames[index], slot);
+
+		light_mutex_lock(&parallel->mutex);
+		slot->state = done ? ZSTD_SLOT_READY : ZSTD_SLOT_FAILED;
+		light_cond_broadcast(&parallel->cond);
+	}
+	light_mutex_unlock(&parallel->mutex);
+
+	free(input);
+	ZSTD_freeDCtx(dctx);
+}
+
+static void __parallel_stop(struct zstd_parallel_t* parallel)
+{
+	if (!parallel->running)
+		return;
+	light_mutex_lock(&parallel->mutex);
+	parallel->stop = true;
+	light_cond_broadcast(&parallel->cond);
+	light_mutex_unlock(&parallel->mutex);
+	for (uint32_t i = 0; i < parallel->worker_count; i++)
+		light_thread_join(parallel->threads[i]);
+	parallel->running = false;
+}
+
+// Workers start decompressing from frame on, nothing is running when this is called
+static bool __parallel_start(struct zstd_parallel_t* parallel, size_t frame)
+{
+	parallel->stop = false;
+	parallel->next_frame = frame;
+	parallel->read_frame = frame;
+	parallel->read_pos = 0;
+	for (size_t i = 0; i < parallel->slot_count; i++)
+		parallel->slots[i].state = ZSTD_SLOT_FREE;
+
+	uint32_t started = 0;
+	while (started < parallel->worker_count && light_thread_create(&parallel->threads[started], __zstd_worker, parallel) == 0)
+		started++;
+	parallel->worker_count = started;
+	parallel->running = true;
+	return started > 0;
+}
+
+// Hands out up to count bytes from the frames in order, buf NULL skips them
+static size_t __parallel_take(struct zstd_parallel_t* parallel, uint8_t* buf, size_t count)
+{
+	size_t done = 0;
+	while (done < count && parallel->read_frame < parallel->frame_count)
+	{
+		struct zstd_slot_t* slot = &parallel->slots[parallel->read_frame % parallel->slot_count];
+		light_mutex_lock(&parallel->mutex);
+		while (slot->state != ZSTD_SLOT_READY && slot->state != ZSTD_SLOT_FAILED)
+			light_cond_wait(&parallel->cond, &parallel->mutex);
+		light_mutex_unlock(&parallel->mutex);
+		if (slot->state == ZSTD_SLOT_FAILED)
+			break;
+
+		// The slot stays ours until it is freed
+		size_t n = MIN(count - done, slot->size - parallel->read_pos);
+		if (buf != NULL)
+			memcpy(buf + done, slot->data + parallel->read_pos, n);
+		parallel->read_pos += n;
+		done += n;
+
+		if (parallel->read_pos == slot->size) {
+			light_mutex_lock(&parallel->mutex);
+			slot->state = ZSTD_SLOT_FREE;
+			parallel->read_frame++;
+			parallel->read_pos = 0;
+			light_cond_broadcast(&parallel->cond);
+			light_mutex_unlock(&parallel->mutex);
+		}
+	}
+	parallel->position += done;
+	return done;
+}
+
+static size_t light_zstd_parallel_read(void* context, void* buf, size_t count)
+{
+	return __parallel_take(context, buf, count);
+}
+
+static int64_t light_zstd_parallel_seek(void* context, int64_t offset, int origin)
+{
+	struct zstd_parallel_t* parallel = context;
+	if (origin == SEEK_CUR) {
+		offset += (int64_t)parallel->position;
+	}
+	else if (origin == SEEK_END) {
+		if (parallel->size == UINT64_MAX) {
+			return -1;
+		}
+		offset += (int64_t)parallel->size;
+	}
+	if (offset < 0) {
+		return -1;
+	}
+	uint64_t target = (uint64_t)offset;
+
+	if (target < parallel->position) {
+		// Restart from the last frame known to start at or before the target
+		size_t frame = 0;
+		while (frame + 1 < parallel->frame_count && parallel->frames[frame + 1].decompressed_offset <= target)
+			frame++;
+		__parallel_stop(parallel);
+		parallel->position = parallel->frames[frame].decompressed_offset;
+		if (!__parallel_start(parallel, frame))
+			return -1;
+	}
+	// Whatever lies before the target is decompressed anyway, frames are read ahead
+	uint64_t skip = target - parallel->position;
+	if (__parallel_take(parallel, NULL, (size_t)skip) != skip)
+		return -1;
+	return (int64_t)parallel->position;
+}
+
+static int64_t light_zstd_parallel_tell(void* context)
+{
+	struct zstd_parallel_t* parallel = context;
+	return (int64_t)parallel->position;
+}
+
+static int light_zstd_parallel_close(void* context)
+{
+	struct zstd_parallel_t* parallel = context;
+	__parallel_stop(parallel);
+	for (size_t i = 0; i < parallel->slot_count; i++)
+		free(parallel->slots[i].data);
+	free(parallel->slots);
+	free(parallel->threads);
+	free(parallel->frames);
+	light_mutex_destroy(&parallel->mutex);
+	light_mutex_destroy(&parallel->file_mutex);
+	light_cond_destroy(&parallel->cond);
+	int res = fclose(parallel->file);
+	free(parallel);
 	return res;
 }
 
+// NULL when the file has less than two frames, the sequential reader does as well then
+static struct zstd_parallel_t* __open_parallel(FILE* file, int num_workers)
+{
+	struct zstd_frame_t* frames = NULL;
+	size_t frame_count = 0;
+	uint64_t size = UINT64_MAX;
+
+	struct zstd_seek_table_t table = { 0 };
+	uint64_t frames_end;
+	if (__seek_table_read(file, &table, &frames_end)) {
+		frames = malloc(table.count * sizeof(struct zstd_frame_t));
+		for (size_t i = 0; frames != NULL && i < table.count; i++) {
+			frames[i].offset = table.points[i].compressed;
+			frames[i].compressed_size = table.points[i + 1].compressed - table.points[i].compressed;
+			frames[i].decompressed_offset = table.points[i].decompressed;
+		}
+		frame_count = frames ? table.count : 0;
+		size = table.points[table.count].decompressed;
+		free(table.points);
+	}
+	else if (!__scan_frames(file, &frames, &frame_count, &size)) {
+		frame_count = 0;
+	}
+	if (frame_count < 2) {
+		free(frames);
+		__file_seek(file, 0, SEEK_SET);
+		return NULL;
+	}
+
+	struct zstd_parallel_t* parallel = calloc(1, sizeof(struct zstd_parallel_t));
+	uint32_t workers = (uint32_t)MIN((size_t)num_workers, frame_count);
+	if (parallel != NULL) {
+		parallel->worker_count = workers;
+		parallel->slot_count = 2 * (size_t)workers;
+		parallel->threads = calloc(workers, sizeof(light_thread));
+		parallel->slots = calloc(parallel->slot_count, sizeof(struct zstd_slot_t));
+	}
+	if (parallel == NULL || parallel->threads == NULL || parallel->slots == NULL) {
+		if (parallel != NULL) {
+			free(parallel->threads);
+			free(parallel->slots);
+		}
+		free(parallel);
+		free(frames);
+		__file_seek(file, 0, SEEK_SET);
+		return NULL;
+	}
+	parallel->file = file;
+	parallel->frames = frames;
+	parallel->frame_count = frame_count;
+	parallel->size = size;
+	light_mutex_init(&parallel->mutex);
+	light_mutex_init(&parallel->file_mutex);
+	light_cond_init(&parallel->cond);
+
+	if (!__parallel_start(parallel, 0)) {
+		parallel->file = NULL;
+		free(parallel->slots);
+		free(parallel->threads);
+		free(parallel->frames);
+		light_mutex_destroy(&parallel->mutex);
+		light_mutex_destroy(&parallel->file_mutex);
+		light_cond_destroy(&parallel->cond);
+		free(parallel);
+		__file_seek(file, 0, SEEK_SET);
+		return NULL;
+	}
+	return parallel;
+}
+
 light_file light_io_zstd_open(const char* filename, const char* mode)
 {
 	// 0 level means default
 	int compression_level = 0;
 	int num_workers = 0;
+	uint64_t frame_size_mb = DEFAULT_FRAME_SIZE_MB;
 
 	// parse mode
 	bool read = false;
 	bool write = false;
+	bool append = false;
 	while (mode && *mode)
 	{
 		if (*mode >= '0' && *mode <= '9') {
@@ -281,21 +1045,29 @@ light_file light_io_zstd_open(const char* filename, const char* mode)
 			//Input is scale 0-9 but zstd goes 1-22!
 			compression_level = (compression_level * 2) + 1;
 		}
-		else if (*mode == ',') {
-			// ",N" suffix -> ZSTD_c_nbWorkers. Multi-digit so callers can
-			// pass values larger than 9.
+		else if (*mode == ',' || *mode == ':') {
+			// ",N" suffix -> ZSTD_c_nbWorkers, ":N" -> frames of N MB.
+			// Multi-digit so callers can pass values larger than 9.
+			bool workers = *mode == ',';
 			++mode;
-			num_workers = 0;
+			uint64_t value = 0;
 			while (*mode >= '0' && *mode <= '9') {
-				num_workers = num_workers * 10 + (*mode - '0');
+				value = MIN(value * 10 + (uint64_t)(*mode - '0'), (uint64_t)INT32_MAX);
 				++mode;
 			}
+			if (workers) {
+				num_workers = (int)value;
+			}
+			else {
+				frame_size_mb = MIN(value, MAX_FRAME_SIZE_MB);
+			}
 			continue;
 		}
 		else {
 			switch (*mode)
 			{
 			case 'b':
+			case '+':
 				break;
 			case 'r':
 				read = true;
@@ -303,21 +1075,30 @@ light_file light_io_zstd_open(const char* filename, const char* mode)
 			case 'w':
 				write = true;
 				break;
+			case 'a':
+				append = true;
+				break;
 			default:
 				return NULL;
 			}
 		}
 		mode++;
 	}
-	if (read && write) {
-		// we don't do that with a compressed file
+	if (read + write + append != 1) {
+		// we don't do that with a compressed file, or what to do with the file then?
 		return NULL;
 	}
-	if (!read && !write) {
-		// what to do with the file then?
-		return NULL;
+
+	FILE* file = NULL;
+	if (append) {
+		// Read and written in place, created when missing
+		file = fopen(filename, "r+b");
+		if (!file)
+			file = fopen(filename, "w+b");
+	}
+	else {
+		file = fopen(filename, read ? "rb" : "wb");
 	}
-	FILE* file = fopen(filename, read ? "rb" : "wb");
 
 	if (!file)
 	{
@@ -326,17 +1107,58 @@ light_file light_io_zstd_open(const char* filename, const char* mode)
 
 	light_file fd = calloc(1, sizeof(struct light_file_t));
 
-	if (read) {
+	struct zstd_parallel_t* parallel = read && num_workers > 1 ? __open_parallel(file, num_workers) : NULL;
+	if (parallel) {
+		fd->context = parallel;
+		fd->fn_read = &light_zstd_parallel_read;
+		fd->fn_seek = &light_zstd_parallel_seek;
+		fd->fn_tell = &light_zstd_parallel_tell;
+		fd->fn_close = &light_zstd_parallel_close;
+	}
+	else if (read) {
 		fd->context = get_zstd_decompression_context(file);
 		fd->fn_read = &light_zstd_read;
+		fd->fn_seek = &light_zstd_seek;
+		fd->fn_tell = &light_zstd_tell;
 		fd->fn_close = &light_zstd_close_r;
 	}
-	else {
-		fd->context = get_zstd_compression_context(file, compression_level, num_workers);
+	else if (write) {
+		struct zstd_compression_t* compression = get_zstd_compression_context(file, compression_level, num_workers);
+		compression->frame_size = frame_size_mb * 1024 * 1024;
+		compression->seekable = compression->frame_size > 0;
+		fd->context = compression;
 		fd->fn_write = &light_zstd_write;
 		fd->fn_close = &light_zstd_close_w;
 	}
+	else {
+		struct zstd_append_t* context = calloc(1, sizeof(struct zstd_append_t));
+		context->decompression = get_zstd_decompression_context(file);
+		context->compression = get_zstd_compression_context(file, compression_level, num_workers);
+		context->compression->frame_size = frame_size_mb * 1024 * 1024;
+		// Frames go on in the seek table that was found; without one, the file
+		// stays a plain stream of frames unless it is new
+		struct zstd_seek_table_t* table = &context->decompression->table;
+		context->compression->seekable = table->count > 0 || context->decompression->frames_end == 0;
+		if (table->count > 0) {
+			struct zstd_seek_table_t* copy = &context->compression->table;
+			copy->points = malloc((table->count + 1) * sizeof(struct zstd_seek_point_t));
+			if (copy->points != NULL) {
+				memcpy(copy->points, table->points, (table->count + 1) * sizeof(struct zstd_seek_point_t));
+				copy->count = table->count;
+				copy->capacity = table->count + 1;
+			}
+			else {
+				context->compression->seekable = false;
+			}
+		}
+		fd->context = context;
+		fd->fn_read = &light_zstd_append_read;
+		fd->fn_write = &light_zstd_append_write;
+		fd->fn_seek = &light_zstd_append_seek;
+		fd->fn_tell = &light_zstd_append_tell;
+		fd->fn_close = &light_zstd_append_close;
+	}
 
 	return fd;
 }
-#endif // LIGHT_USE_ZSTD
\ No newline at end of file
+#endif // LIGHT_USE_ZSTD
@@ -20,6 +20,12 @@
 // SOFTWARE.
 
 #include "light_pcapng.h"
+#include "light_internal.h"
+#include "light_byteorder.h"
+
+#include <string.h>
+
+#include "endianness.h"
 
 light_option light_find_option(const light_block pcapng, uint16_t option_code)
 {
@@ -38,3 +44,55 @@ light_option light_find_option(const light_block pcapng, uint16_t option_code)
 
 	return iterator;
 }
+
+const uint8_t* light_find_option_view(const uint8_t* options, uint32_t options_length, uint16_t option_code, uint16_t* option_length, const bool swap_endianness)
+{
+	const uint8_t* iterator = options;
+	const uint8_t* end = options + options_length;
+
+	while (end - iterator >= 4) {
+		uint16_t code, length;
+		memcpy(&code, iterator, sizeof(code));
+		memcpy(&length, iterator + 2, sizeof(length));
+		if (swap_endianness) {
+			code = bswap16(code);
+			length = bswap16(length);
+		}
+		iterator += 4;
+		uint32_t actual_length = ((uint32_t)length + 3) & ~3u;
+		if (code == 0 || actual_length > (size_t)(end - iterator)) {
+			// End of options, or the rest is garbage
+			break;
+		}
+		if (code == option_code) {
+			*option_length = length;
+			return iterator;
+		}
+		iterator += actual_length;
+	}
+
+	return NULL;
+}
+
+void light_index_options(light_option_index* index, const light_block_view* view, bool swap_endianness)
+{
+	if (swap_endianness) {
+		light_index_options_swapped(index, view);
+	}
+	else {
+		light_index_options_native(index, view);
+	}
+}
+
+const uint8_t* light_index_find_option(const light_option_index* index, uint16_t option_code, uint16_t* option_length)
+{
+	if (option_code >= LIGHT_OPTION_INDEX_SIZE) {
+		// Not indexed, decode the raw span on demand
+		return light_find_option_view(index->options, index->options_length, option_code, option_length, index->swap_endianness);
+	}
+	if (!(index->present & (1u << option_code))) {
+		return NULL;
+	}
+	*option_length = index->length[option_code];
+	return index->data[option_code];
+}
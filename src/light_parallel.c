@@ -0,0 +1,552 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "light_pcapng_ext.h"
+#include "light_pcapng.h"
+#include "light_debug.h"
+#include "light_io_mem.h"
+#include "light_io_mmap.h"
+#include "light_internal.h"
+#include "light_io_internal.h"
+#include "light_pcapng_ext_internal.h"
+#include "light_thread.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define MIN(x, y) (((x) < (y)) ? (x) : (y))
+#define MAX(x, y) (((x) > (y)) ? (x) : (y))
+
+#define PARALLEL_MIN_CHUNK (1024 * 1024)
+#define PARALLEL_MAX_CHUNK (64 * 1024 * 1024)
+// Chunks per worker when splitting automatically, keeps every worker busy until the end
+#define PARALLEL_CHUNKS_PER_WORKER 4
+// Parsed chunks waiting for in order delivery, per worker
+#define PARALLEL_WINDOW_PER_WORKER 2
+
+typedef struct parallel_record {
+	uint32_t interface_id;
+	size_t comment_offset;
+	light_packet_header header;
+	const uint8_t* data;
+} parallel_record;
+
+typedef struct parallel_chunk {
+	// Byte range assigned to the chunk, blocks starting in it belong to it
+	size_t nominal_start;
+	size_t nominal_end;
+
+	// First block and the end of the last one, found by walking the blocks
+	size_t start;
+	size_t end;
+	bool swap_start;
+	bool swap_end;
+	bool corrupt;
+
+	// Section headers and interface blocks of the chunk
+	size_t* context;
+	size_t context_count;
+	size_t context_capacity;
+
+	// Interface state at the start of the chunk, handed over to its reader
+	light_packet_interface* interfaces;
+	size_t interfaces_count;
+	uint32_t section_interface_offset;
+
+	// Packets waiting for in order delivery
+	parallel_record* records;
+	size_t record_count;
+	size_t record_capacity;
+	char* comments;
+	size_t comments_used;
+	size_t comments_size;
+
+	uint32_t worker;
+	bool done;
+} parallel_chunk;
+
+typedef struct parallel_reader {
+	const uint8_t* data;
+	size_t size;
+
+	parallel_chunk* chunks;
+	size_t chunk_count;
+
+	const light_packet_interface* interfaces;
+	size_t interfaces_count;
+
+	uint32_t flags;
+	light_packet_callback callback;
+	void* context;
+
+	light_mutex mutex;
+	light_cond cond;
+	size_t next_chunk;
+	size_t delivered;
+	size_t window;
+	uint32_t next_worker;
+	int result;
+	bool stop;
+} parallel_reader;
+
+static void __walk_chunk(const parallel_reader* reader, parallel_chunk* chunk)
+{
+	size_t offset = chunk->start;
+	bool swap = chunk->swap_start;
+
+	chunk->context_count = 0;
+	chunk->corrupt = false;
+	while (offset < chunk->nominal_end && offset < reader->size) {
+		uint32_t type, length;
+		if (!light_check_block(reader->data, reader->size, offset, &swap, &type, &length)) {
+			// The sequential reader stops here as well
+			chunk->corrupt = true;
+			break;
+		}
+		if (type == LIGHT_SECTION_HEADER_BLOCK || type == LIGHT_INTERFACE_BLOCK) {
+			if (chunk->context_count == chunk->context_capacity) {
+				size_t capacity = chunk->context_capacity ? chunk->context_capacity * 2 : 16;
+				size_t* context = realloc(chunk->context, capacity * sizeof(size_t));
+				if (context == NULL) {
+					chunk->corrupt = true;
+					break;
+				}
+				chunk->context = context;
+				chunk->context_capacity = capacity;
+			}
+			chunk->context[chunk->context_count++] = offset;
+		}
+		offset += length;
+	}
+
+	chunk->end = MAX(offset, chunk->start);
+	chunk->swap_end = swap;
+}
+
+static void __scan_worker(void* arg)
+{
+	parallel_reader* reader = arg;
+	while (1) {
+		light_mutex_lock(&reader->mutex);
+		size_t index = reader->next_chunk++;
+		light_mutex_unlock(&reader->mutex);
+		if (index >= reader->chunk_count) {
+			return;
+		}
+
+		parallel_chunk* chunk = &reader->chunks[index];
+		if (index == 0) {
+			chunk->start = 0;
+			chunk->swap_start = false;
+		}
+		else {
+			// Blocks are 32 bit aligned from the start of the file
+			chunk->start = light_find_block_range(reader->data, reader->size, chunk->nominal_start, reader->size, 4, &chunk->swap_start);
+		}
+		__walk_chunk(reader, chunk);
+	}
+}
+
+static light_packet_interface* __copy_interfaces(const light_packet_interface* interfaces, size_t count)
+{
+	light_packet_interface* copy = calloc(count + 1, sizeof(light_packet_interface));
+	DCHECK_NULLP(copy, return NULL);
+	for (size_t i = 0; i < count; i++) {
+		copy[i] = interfaces[i];
+		copy[i].name = interfaces[i].name ? strdup(interfaces[i].name) : NULL;
+		copy[i].description = interfaces[i].description ? strdup(interfaces[i].description) : NULL;
+	}
+	return copy;
+}
+
+// Chains the chunks from the start of the file, re-walking any chunk whose guessed start was wrong,
+// and plays section headers and interfaces in file order to give each chunk its starting state
+static int __merge_chunks(parallel_reader* reader, light_pcapng context)
+{
+	size_t previous_end = 0;
+	bool previous_swap = false;
+	bool stopped = false;
+
+	for (size_t i = 0; i < reader->chunk_count; i++) {
+		parallel_chunk* chunk = &reader->chunks[i];
+
+		if (i > 0) {
+			if (stopped) {
+				chunk->start = previous_end;
+				chunk->end = previous_end;
+				chunk->context_count = 0;
+			}
+			else if (chunk->start != previous_end || chunk->swap_start != previous_swap) {
+				chunk->start = previous_end;
+				chunk->swap_start = previous_swap;
+				__walk_chunk(reader, chunk);
+			}
+		}
+
+		chunk->interfaces = __copy_interfaces(context->interfaces, context->interfaces_count);
+		DCHECK_NULLP(chunk->interfaces, return LIGHT_OUT_OF_MEMORY);
+		chunk->interfaces_count = context->interfaces_count;
+		chunk->section_interface_offset = context->section_interface_offset;
+
+		for (size_t j = 0; j < chunk->context_count; j++) {
+			light_block_view view;
+			if (light_io_seek(context->file, (int64_t)chunk->context[j], SEEK_SET) < 0
+				|| light_read_block_view(context->file, &view, &context->swap_endianness) != LIGHT_SUCCESS
+				|| light_pcapng_track_block(context, &view) != LIGHT_SUCCESS) {
+				return LIGHT_FAILURE;
+			}
+		}
+
+		previous_end = chunk->end;
+		previous_swap = chunk->swap_end;
+		stopped = stopped || chunk->corrupt;
+	}
+
+	return LIGHT_SUCCESS;
+}
+
+static int __record_packet(parallel_chunk* chunk, uint32_t interface_id, const light_packet_header* header, const uint8_t* data)
+{
+	if (chunk->record_count == chunk->record_capacity) {
+		size_t capacity = chunk->record_capacity ? chunk->record_capacity * 2 : 256;
+		parallel_record* records = realloc(chunk->records, capacity * sizeof(parallel_record));
+		DCHECK_NULLP(records, return LIGHT_OUT_OF_MEMORY);
+		chunk->records = records;
+		chunk->record_capacity = capacity;
+	}
+
+	parallel_record* record = &chunk->records[chunk->record_count++];
+	record->interface_id = interface_id;
+	record->header = *header;
+	record->header.comment = NULL;
+	record->data = data;
+	record->comment_offset = 0;
+
+	if (header->comment != NULL) {
+		// Comments live in the reader until the next packet, keep a copy
+		size_t needed = chunk->comments_used + header->comment_length + 1;
+		if (needed > chunk->comments_size) {
+			size_t size = MAX(needed, chunk->comments_size * 2);
+			char* comments = realloc(chunk->comments, size);
+			DCHECK_NULLP(comments, return LIGHT_OUT_OF_MEMORY);
+			chunk->comments = comments;
+			chunk->comments_size = size;
+		}
+		record->comment_offset = chunk->comments_used;
+		memcpy(chunk->comments + chunk->comments_used, header->comment, header->comment_length);
+		chunk->comments[chunk->comments_used + header->comment_length] = '\0';
+		chunk->comments_used = needed;
+		record->header.comment = chunk->comments;
+	}
+
+	return LIGHT_SUCCESS;
+}
+
+static void __stop(parallel_reader* reader, int result)
+{
+	light_mutex_lock(&reader->mutex);
+	if (!reader->stop) {
+		reader->stop = true;
+		reader->result = result;
+	}
+	light_cond_broadcast(&reader->cond);
+	light_mutex_unlock(&reader->mutex);
+}
+
+static int __parse_chunk(parallel_reader* reader, parallel_chunk* chunk, uint32_t worker)
+{
+	bool ordered = (reader->flags & LIGHT_PARALLEL_ORDERED) != 0;
+
+	struct light_pcapng_t* pcapng = calloc(1, sizeof(struct light_pcapng_t));
+	DCHECK_NULLP(pcapng, return LIGHT_OUT_OF_MEMORY);
+	pcapng->file = light_io_mem_create((void*)(reader->data + chunk->start), chunk->end - chunk->start);
+	light_pcapng_set_byte_order(pcapng, chunk->swap_start);
+	pcapng->interfaces = chunk->interfaces;
+	pcapng->interfaces_count = chunk->interfaces_count;
+	pcapng->section_interface_offset = chunk->section_interface_offset;
+	pcapng->read_flags = LIGHT_READ_BORROWED;
+	pcapng->snaplen = LIGHT_SNAPLEN_UNLIMITED;
+	chunk->interfaces = NULL;
+
+	int res = LIGHT_SUCCESS;
+	if (pcapng->file == NULL) {
+		res = LIGHT_OUT_OF_MEMORY;
+	}
+
+	uint32_t count = 0;
+	while (res == LIGHT_SUCCESS) {
+		uint32_t interface_id = 0;
+		light_packet_header header;
+		const uint8_t* data = NULL;
+		if (light_pcapng_next_packet(pcapng, &interface_id, &header, &data) != LIGHT_SUCCESS) {
+			// End of the chunk
+			break;
+		}
+
+		if (ordered) {
+			res = __record_packet(chunk, interface_id, &header, data);
+		}
+		else {
+			const light_packet_interface* packet_interface = interface_id < reader->interfaces_count ? &reader->interfaces[interface_id] : NULL;
+			res = reader->callback(reader->context, worker, interface_id, packet_interface, &header, data);
+		}
+
+		// Somebody else may have asked to stop
+		if ((++count & 0xFF) == 0) {
+			light_mutex_lock(&reader->mutex);
+			bool stop = reader->stop;
+			light_mutex_unlock(&reader->mutex);
+			if (stop) {
+				break;
+			}
+		}
+	}
+
+	light_pcapng_close(pcapng);
+	return res;
+}
+
+// Parses one chunk and marks it done, called without the mutex
+static void __parse_one(parallel_reader* reader, size_t index, uint32_t worker)
+{
+	parallel_chunk* chunk = &reader->chunks[index];
+	chunk->worker = worker;
+	int res = __parse_chunk(reader, chunk, worker);
+	if (res != LIGHT_SUCCESS) {
+		__stop(reader, res);
+	}
+
+	light_mutex_lock(&reader->mutex);
+	chunk->done = true;
+	light_cond_broadcast(&reader->cond);
+	light_mutex_unlock(&reader->mutex);
+}
+
+static void __parse_worker(void* arg)
+{
+	parallel_reader* reader = arg;
+	bool ordered = (reader->flags & LIGHT_PARALLEL_ORDERED) != 0;
+
+	light_mutex_lock(&reader->mutex);
+	uint32_t worker = reader->next_worker++;
+	while (1) {
+		// In order delivery holds back parsing once enough chunks wait for the caller
+		while (!reader->stop && ordered && reader->next_chunk < reader->chunk_count
+			&& reader->next_chunk >= reader->delivered + reader->window) {
+			light_cond_wait(&reader->cond, &reader->mutex);
+		}
+		if (reader->stop || reader->next_chunk >= reader->chunk_count) {
+			break;
+		}
+		size_t index = reader->next_chunk++;
+		light_mutex_unlock(&reader->mutex);
+
+		__parse_one(reader, index, worker);
+
+		light_mutex_lock(&reader->mutex);
+	}
+	light_mutex_unlock(&reader->mutex);
+}
+
+// Runs on the calling thread, hands the chunks over in file order as they get parsed.
+// Without workers each chunk is parsed here right before it is handed over.
+static void __deliver_ordered(parallel_reader* reader, bool parse)
+{
+	for (size_t i = 0; i < reader->chunk_count; i++) {
+		parallel_chunk* chunk = &reader->chunks[i];
+
+		if (parse && !reader->stop) {
+			reader->next_chunk = i + 1;
+			__parse_one(reader, i, 0);
+		}
+
+		light_mutex_lock(&reader->mutex);
+		while (!chunk->done && !reader->stop) {
+			light_cond_wait(&reader->cond, &reader->mutex);
+		}
+		bool stop = reader->stop;
+		light_mutex_unlock(&reader->mutex);
+		if (stop) {
+			return;
+		}
+
+		for (size_t j = 0; j < chunk->record_count; j++) {
+			parallel_record* record = &chunk->records[j];
+			if (record->header.comment != NULL) {
+				record->header.comment = chunk->comments + record->comment_offset;
+			}
+			const light_packet_interface* packet_interface = record->interface_id < reader->interfaces_count ? &reader->interfaces[record->interface_id] : NULL;
+			int res = reader->callback(reader->context, chunk->worker, record->interface_id, packet_interface, &record->header, record->data);
+			if (res != 0) {
+				__stop(reader, res);
+				return;
+			}
+		}
+
+		free(chunk->records);
+		free(chunk->comments);
+		chunk->records = NULL;
+		chunk->comments = NULL;
+
+		light_mutex_lock(&reader->mutex);
+		reader->delivered = i + 1;
+		light_cond_broadcast(&reader->cond);
+		light_mutex_unlock(&reader->mutex);
+	}
+}
+
+static int __run_workers(parallel_reader* reader, uint32_t workers, void (*fn)(void* arg), bool deliver)
+{
+	light_thread* threads = calloc(workers, sizeof(light_thread));
+	DCHECK_NULLP(threads, return LIGHT_OUT_OF_MEMORY);
+
+	uint32_t started = 0;
+	while (started < workers && light_thread_create(&threads[started], fn, reader) == 0) {
+		started++;
+	}
+	if (started == 0 && !deliver) {
+		// No threads at all, do the work here
+		fn(reader);
+	}
+
+	if (deliver) {
+		// Parsing everything first would wait on the delivery window forever, interleave them instead
+		__deliver_ordered(reader, started == 0);
+	}
+
+	for (uint32_t i = 0; i < started; i++) {
+		light_thread_join(threads[i]);
+	}
+	free(threads);
+	return LIGHT_SUCCESS;
+}
+
+static void __free_chunks(parallel_chunk* chunks, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		parallel_chunk* chunk = &chunks[i];
+		for (size_t j = 0; chunk->interfaces != NULL && j < chunk->interfaces_count; j++) {
+			free(chunk->interfaces[j].name);
+			free(chunk->interfaces[j].description);
+		}
+		free(chunk->interfaces);
+		free(chunk->context);
+		free(chunk->records);
+		free(chunk->comments);
+	}
+	free(chunks);
+}
+
+int light_pcapng_read_parallel(const char* file_path, uint32_t workers, size_t chunk_size, uint32_t flags, light_packet_callback callback, void* context)
+{
+	DCHECK_NULLP(file_path, return LIGHT_INVALID_ARGUMENT);
+	DCHECK_NULLP(callback, return LIGHT_INVALID_ARGUMENT);
+
+	light_file file = light_io_mmap_open(file_path);
+	if (file == NULL) {
+		return LIGHT_FAILURE;
+	}
+
+	// The mapping lends the whole file at once
+	int64_t size = -1;
+	if (light_io_seek(file, 0, SEEK_END) >= 0) {
+		size = light_io_tell(file);
+	}
+	if (size <= 0 || light_io_seek(file, 0, SEEK_SET) < 0) {
+		light_io_close(file);
+		return size == 0 ? LIGHT_SUCCESS : LIGHT_FAILURE;
+	}
+	const uint8_t* data = light_io_borrow(file, (size_t)size);
+	if (data == NULL) {
+		light_io_close(file);
+		return LIGHT_FAILURE;
+	}
+
+	// Chunks look for blocks in the byte order of the first section, the merge fixes up any other
+	bool swap = false;
+	uint32_t first_type, first_length;
+	if (!light_check_block(data, (size_t)size, 0, &swap, &first_type, &first_length) || first_type != LIGHT_SECTION_HEADER_BLOCK) {
+		// Not a capture, light_pcapng_open turns it down as well
+		light_io_close(file);
+		return LIGHT_FAILURE;
+	}
+
+	if (workers == 0) {
+		workers = light_cpu_count();
+	}
+	if (chunk_size == 0) {
+		chunk_size = (size_t)size / ((size_t)workers * PARALLEL_CHUNKS_PER_WORKER);
+		chunk_size = MIN(MAX(chunk_size, PARALLEL_MIN_CHUNK), PARALLEL_MAX_CHUNK);
+	}
+
+	parallel_reader reader = { 0 };
+	reader.data = data;
+	reader.size = (size_t)size;
+	reader.flags = flags;
+	reader.callback = callback;
+	reader.context = context;
+	reader.window = (size_t)workers * PARALLEL_WINDOW_PER_WORKER;
+	reader.chunk_count = (reader.size + chunk_size - 1) / chunk_size;
+	reader.chunks = calloc(reader.chunk_count, sizeof(parallel_chunk));
+	light_pcapng state = calloc(1, sizeof(struct light_pcapng_t));
+	if (reader.chunks == NULL || state == NULL) {
+		free(reader.chunks);
+		free(state);
+		light_io_close(file);
+		return LIGHT_OUT_OF_MEMORY;
+	}
+	for (size_t i = 0; i < reader.chunk_count; i++) {
+		reader.chunks[i].swap_start = swap;
+		reader.chunks[i].nominal_start = i * chunk_size;
+		reader.chunks[i].nominal_end = MIN((i + 1) * chunk_size, reader.size);
+	}
+	workers = (uint32_t)MIN((size_t)workers, reader.chunk_count);
+
+	light_mutex_init(&reader.mutex);
+	light_cond_init(&reader.cond);
+
+	// First pass finds the chunk boundaries, section headers and interfaces
+	int res = __run_workers(&reader, workers, __scan_worker, false);
+	if (res == LIGHT_SUCCESS) {
+		state->file = light_io_mem_create((void*)data, reader.size);
+		state->snaplen = LIGHT_SNAPLEN_UNLIMITED;
+		res = state->file ? __merge_chunks(&reader, state) : LIGHT_OUT_OF_MEMORY;
+	}
+
+	// Second pass parses the packets, with the interface table of the whole file at hand
+	if (res == LIGHT_SUCCESS) {
+		reader.interfaces = state->interfaces;
+		reader.interfaces_count = state->interfaces_count;
+		reader.next_chunk = 0;
+		res = __run_workers(&reader, workers, __parse_worker, (flags & LIGHT_PARALLEL_ORDERED) != 0);
+	}
+	if (res == LIGHT_SUCCESS && reader.stop) {
+		res = reader.result;
+	}
+
+	light_cond_destroy(&reader.cond);
+	light_mutex_destroy(&reader.mutex);
+	__free_chunks(reader.chunks, reader.chunk_count);
+	light_pcapng_close(state);
+	light_io_close(file);
+
+	return res;
+}
@@ -24,6 +24,8 @@
 #include "light_debug.h"
 #include "light_util.h"
 #include "light_io.h"
+#include "light_io_internal.h"
+#include "light_internal.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -32,6 +34,9 @@
 #include "endianness.h"
 
 #define MIN(x, y) (((x) < (y)) ? (x) : (y))
+#define MAX(x, y) (((x) > (y)) ? (x) : (y))
+
+#define SKIP_CHUNK_SIZE 65536
 
 // Documentation from: https://github.com/pcapng/pcapng
 
@@ -83,58 +88,63 @@ void fix_endianness_option(struct light_option_t* opt, const bool swap_endiannes
 
 static light_option __parse_options(const uint8_t** memory, const int32_t max_len, const bool swap_endianness)
 {
-	if (max_len <= 0) {
-		return NULL;
-	}
 	// size of code and length
 	const int32_t header_size = sizeof(uint16_t) + sizeof(uint16_t);
 	const int32_t allignment = sizeof(uint32_t);
-	if (max_len < header_size) {
-		// Garbage data, not enough to read header
-		*memory += max_len;
-		return NULL;
-	}
-
-	light_option opt = calloc(1, sizeof(struct light_option_t));
 
+	light_option first = NULL;
+	light_option* next = &first;
 	int32_t remaining_size = max_len;
 
-	opt->code = *(uint16_t*)*memory;
-	*memory += sizeof(uint16_t);
-	opt->length = *(uint16_t*)*memory;
-	*memory += sizeof(uint16_t);
-	remaining_size -= header_size;
-	fix_endianness_option(opt, swap_endianness);
+	while (remaining_size > 0)
+	{
+		if (remaining_size < header_size) {
+			// Garbage data, not enough to read header
+			*memory += remaining_size;
+			break;
+		}
 
-	int32_t actual_length = (opt->length % allignment) == 0 ?
-		opt->length :
-		(opt->length / allignment + 1) * allignment;
+		light_option opt = calloc(1, sizeof(struct light_option_t));
+		DCHECK_NULLP(opt, break);
+
+		opt->code = *(uint16_t*)*memory;
+		*memory += sizeof(uint16_t);
+		opt->length = *(uint16_t*)*memory;
+		*memory += sizeof(uint16_t);
+		remaining_size -= header_size;
+		fix_endianness_option(opt, swap_endianness);
+
+		int32_t actual_length = (opt->length % allignment) == 0 ?
+			opt->length :
+			(opt->length / allignment + 1) * allignment;
+
+		if (actual_length > remaining_size) {
+			// We got invalid length value
+			// Discard the option and the rest of the memory
+			free(opt);
+			*memory += remaining_size;
+			break;
+		}
 
-	if (actual_length > remaining_size) {
-		// We got invalid length value
-		// Discard the option and the rest of the memory
-		free(opt);
-		*memory += remaining_size;
-		return NULL;
-	}
+		if (actual_length > 0) {
+			opt->data = calloc(1, actual_length);
+			memcpy(opt->data, *memory, actual_length);
+			*memory += actual_length;
+			remaining_size -= actual_length;
+		}
 
-	if (actual_length > 0) {
-		opt->data = calloc(1, actual_length);
-		memcpy(opt->data, *memory, actual_length);
-		*memory += actual_length;
-		remaining_size += actual_length;
-	}
+		*next = opt;
+		next = &opt->next_option;
 
-	if (opt->code == 0) {
-		DCHECK_ASSERT(opt->length, 0);
-		// Treat the remaining data as garbage and discard it
-		*memory += remaining_size;
-	}
-	else {
-		opt->next_option = __parse_options(memory, remaining_size, swap_endianness);
+		if (opt->code == 0) {
+			DCHECK_ASSERT(opt->length, 0);
+			// Treat the remaining data as garbage and discard it
+			*memory += remaining_size;
+			break;
+		}
 	}
 
-	return opt;
+	return first;
 }
 
 /// <summary>
@@ -274,12 +284,40 @@ void parse_by_type(light_block current, const uint8_t* local_data, const bool sw
 	}
 }
 
+static uint32_t __options_offset(uint32_t type, const uint8_t* body, uint32_t body_length, const bool swap_endianness)
+{
+	uint64_t offset = body_length;
+
+	switch (type)
+	{
+	case LIGHT_SECTION_HEADER_BLOCK:
+		offset = sizeof(struct _light_section_header);
+		break;
+	case LIGHT_INTERFACE_BLOCK:
+		offset = sizeof(struct _light_interface_description_block);
+		break;
+	case LIGHT_ENHANCED_PACKET_BLOCK:
+		if (body_length >= sizeof(struct _light_enhanced_packet_block)) {
+			uint32_t len = ((const struct _light_enhanced_packet_block*)body)->capture_packet_length;
+			if (swap_endianness) len = bswap32(len);
+			uint64_t actual_len = 0;
+			PADD32((uint64_t)len, &actual_len);
+			offset = sizeof(struct _light_enhanced_packet_block) + actual_len;
+		}
+		break;
+	}
+
+	return (uint32_t)MIN(offset, (uint64_t)body_length);
+}
+
 /// <summary>
-/// Returns a full record as read out of the file
+/// Reads the type and length of the next record, the record stays pending until it is read or skipped
 /// </summary>
 /// <param name="fd">File to read from</param>
-/// <returns>The block read from the file - may contain sub blocks</returns>
-void light_read_block(light_file fd, light_block* block, bool* swap_endianness)
+/// <param name="type">Block type of the next record</param>
+/// <param name="total_length">Total length of the next record, header and trailer included</param>
+/// <returns>LIGHT_SUCCESS, or LIGHT_FAILURE on end of file or malformed header</returns>
+int light_peek_block_header(light_file fd, uint32_t* type, uint32_t* total_length, bool* swap_endianness)
 {
 	//FYI general block structure is like this
 
@@ -295,116 +333,371 @@ void light_read_block(light_file fd, light_block* block, bool* swap_endianness)
 	// +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 	// |                     Block Total Length                        |
 	// +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-	if (block && *block) {
-		light_free_block(*block);
+	if (!fd->peeked)
+	{
+		fd->peeked_offset = fd->position;
+
+		//See the block type and size, if end of file this will tell us
+		uint32_t header[2];
+		size_t bytesRead = light_io_read(fd, header, sizeof(header));
+		if (bytesRead != sizeof(header))
+		{
+			// Normal EOF
+			return LIGHT_FAILURE;
+		}
+		uint32_t blockType = header[0];
+		uint32_t blockSize = header[1];
+		bool section_header = (blockType == LIGHT_SECTION_HEADER_BLOCK);
+
+		uint32_t byte_order_magic = 0;
+		// Lets peek ahead and figure out the endianess.
+		if (section_header) {
+			bytesRead = light_io_read(fd, &byte_order_magic, 4);
+			if (bytesRead != sizeof(byte_order_magic))
+			{
+				return LIGHT_FAILURE;
+			}
+			*swap_endianness = (byte_order_magic != BYTE_ORDER_MAGIC);
+
+			if (*swap_endianness) {
+				assert(byte_order_magic == 0x4D3C2B1A);
+			}
+		}
+
+		if (*swap_endianness) {
+			blockType = bswap32(blockType);
+			blockSize = bswap32(blockSize);
+		}
+
+		//rules for file say this must be on 32bit boundary
+		if (blockSize < 3 * sizeof(uint32_t) || (blockSize % 4) != 0) {
+			return LIGHT_FAILURE;
+		}
+		// Section header body is at least magic, versions and section length
+		if (section_header && blockSize < 3 * sizeof(uint32_t) + 16) {
+			return LIGHT_FAILURE;
+		}
+
+		fd->peeked = true;
+		fd->peeked_type = blockType;
+		fd->peeked_length = blockSize;
+		fd->peeked_magic = byte_order_magic;
 	}
-	*block = NULL;
-	light_block current = NULL;
-	uint8_t* local_data = NULL;
 
-	//See the block type, if end of file this will tell us
+	*type = fd->peeked_type;
+	*total_length = fd->peeked_length;
+
+	return LIGHT_SUCCESS;
+}
+
+int light_peek_block_body(light_file fd, uint32_t count, const uint8_t** body, uint32_t* available, bool* swap_endianness)
+{
 	uint32_t blockType, blockSize;
-	size_t bytesRead;
-	bytesRead = light_io_read(fd, &blockType, sizeof(blockType));
-	if (bytesRead != sizeof(blockType))
-	{
-		// Normal EOF, we did not allocate anything
-		return;
+	int res = light_peek_block_header(fd, &blockType, &blockSize, swap_endianness);
+	if (res != LIGHT_SUCCESS) {
+		return res;
+	}
+	if (blockType == LIGHT_SECTION_HEADER_BLOCK) {
+		return LIGHT_INVALID_ARGUMENT;
 	}
-	bool section_header = (blockType == LIGHT_SECTION_HEADER_BLOCK);
 
-	//A block remains to be read so allocate here
-	current = calloc(1, sizeof(struct light_block_t));
-	DCHECK_NULLP(current, goto failed);
+	uint32_t bodySize = blockSize - 3 * sizeof(uint32_t);
+	count = MIN(count, bodySize);
 
-	//From here on if there is malformed block data we need to release the block we just allocated!
+	if (fd->peeked_body_length == 0) {
+		// Borrowing takes the whole block at once, the later read is then free
+		const uint8_t* data = light_io_borrow(fd, bodySize + sizeof(uint32_t));
+		if (data != NULL) {
+			fd->peeked_body = data;
+			fd->peeked_body_length = bodySize + sizeof(uint32_t);
+		}
+	}
 
-	//Get block size
-	bytesRead = light_io_read(fd, &current->total_length, sizeof(blockSize));
-	if (bytesRead != sizeof(blockSize))
-	{
-		goto failed;
+	if (fd->peeked_body_length < count) {
+		uint32_t have = fd->peeked_body_length;
+		uint8_t* buffer = light_io_grow(fd, count, have);
+		DCHECK_NULLP(buffer, return LIGHT_OUT_OF_MEMORY);
+		if (light_io_read(fd, buffer + have, count - have) != count - have) {
+			return LIGHT_FAILURE;
+		}
+		fd->peeked_body = buffer;
+		fd->peeked_body_length = count;
 	}
 
-	uint32_t byte_order_magic = 0;
-	// Lets peek ahead and figure out the endianess.
-	if (section_header) {
-		assert(current->total_length != 0);
-		bytesRead = light_io_read(fd, &byte_order_magic, 4);
-		if (bytesRead != sizeof(byte_order_magic))
-		{
-			goto failed;
+	*body = fd->peeked_body;
+	*available = MIN(fd->peeked_body_length, bodySize);
+
+	return LIGHT_SUCCESS;
+}
+
+// Consumes count bytes of the file, the first keep bytes of the scratch buffer are preserved
+static int __skip_bytes(light_file fd, uint32_t count, size_t keep)
+{
+	// Straight to the backend, seeking from inside a pending block must not drop it
+	if (fd->fn_seek != NULL && fd->unread_offset == fd->unread_size && fd->fn_seek(fd->context, count, SEEK_CUR) >= 0) {
+		if (fd->position >= 0) {
+			fd->position += count;
 		}
-		*swap_endianness = (byte_order_magic != BYTE_ORDER_MAGIC);
+		return LIGHT_SUCCESS;
+	}
 
-		if (*swap_endianness) {
-			assert(byte_order_magic == 0x4D3C2B1A);
+	// Not seekable, read through the scratch buffer instead
+	uint32_t chunk = MIN(count, SKIP_CHUNK_SIZE);
+	uint8_t* buffer = light_io_grow(fd, keep + chunk, keep);
+	DCHECK_NULLP(buffer, return LIGHT_OUT_OF_MEMORY);
+	while (count > 0) {
+		size_t len = MIN(count, chunk);
+		if (light_io_read(fd, buffer + keep, len) != len) {
+			return LIGHT_FAILURE;
 		}
+		count -= len;
 	}
 
-	if (*swap_endianness) {
-		blockType = bswap32(blockType);
-		current->total_length = bswap32(current->total_length);
+	return LIGHT_SUCCESS;
+}
+
+/// <summary>
+/// Moves past the next record without reading its body
+/// </summary>
+/// <param name="fd">File to read from, seeked when the backend allows it</param>
+/// <returns>LIGHT_SUCCESS, or LIGHT_FAILURE on end of file or malformed header</returns>
+int light_skip_block(light_file fd, bool* swap_endianness)
+{
+	uint32_t blockType, blockSize;
+	int res = light_peek_block_header(fd, &blockType, &blockSize, swap_endianness);
+	if (res != LIGHT_SUCCESS) {
+		return res;
 	}
-	current->type = blockType;
+	fd->peeked = false;
 
-	//rules for file say this must be on 32bit boundary
-	assert((current->total_length % 4) == 0);
+	// Body and trailer, minus the magic or body bytes a peek already took
+	uint32_t remaining = blockSize - 2 * sizeof(uint32_t);
+	if (blockType == LIGHT_SECTION_HEADER_BLOCK) {
+		remaining -= sizeof(uint32_t);
+	}
+	remaining -= fd->peeked_body_length;
+	fd->peeked_body_length = 0;
+	if (remaining == 0) {
+		return LIGHT_SUCCESS;
+	}
 
-	//Pull out the block contents from the file
-	uint32_t bytesToRead = current->total_length - 2 * sizeof(blockSize) - sizeof(blockType);
-	local_data = calloc(bytesToRead, 1);
-	DCHECK_NULLP(local_data, goto failed);
+	return __skip_bytes(fd, remaining, 0);
+}
 
-	if (section_header) {
-		if (bytesToRead < 16) {
-			goto failed;
-		}
+/// <summary>
+/// Reads the next record out of the file into memory owned by the file
+/// </summary>
+/// <param name="fd">File to read from</param>
+/// <param name="view">Filled with the block layout, valid until the next read</param>
+/// <returns>LIGHT_SUCCESS, or LIGHT_FAILURE on end of file or malformed block</returns>
+int light_read_block_view(light_file fd, light_block_view* view, bool* swap_endianness)
+{
+	DCHECK_NULLP(view, return LIGHT_INVALID_ARGUMENT);
+
+	uint32_t blockType, blockSize;
+	size_t bytesRead;
+	int res = light_peek_block_header(fd, &blockType, &blockSize, swap_endianness);
+	if (res != LIGHT_SUCCESS) {
+		return res;
+	}
+	fd->peeked = false;
+
+	bool section_header = (blockType == LIGHT_SECTION_HEADER_BLOCK);
+	uint32_t byte_order_magic = fd->peeked_magic;
+	const uint8_t* peeked_body = fd->peeked_body;
+	uint32_t peeked_length = fd->peeked_body_length;
+	fd->peeked_body_length = 0;
+
+	//Pull out the block contents and the trailing length in one go
+	uint32_t bodySize = blockSize - 2 * sizeof(blockSize) - sizeof(blockType);
+	uint32_t bytesToRead = bodySize + sizeof(blockSize);
+	const uint8_t* local_data = NULL;
+
+	if (peeked_length == bytesToRead) {
+		local_data = peeked_body;
+	}
+	else if (!section_header && peeked_length == 0) {
+		// Parse in place when the backend can hand out its own memory
+		local_data = light_io_borrow(fd, bytesToRead);
+	}
+
+	if (local_data != NULL) {
+		bytesRead = bytesToRead;
+	}
+	else if (peeked_length > 0) {
+		// Only the rest of the block is left in the file
+		uint8_t* buffer = light_io_grow(fd, bytesToRead, peeked_length);
+		DCHECK_NULLP(buffer, return LIGHT_OUT_OF_MEMORY);
+		bytesRead = light_io_read(fd, buffer + peeked_length, bytesToRead - peeked_length);
+		bytesRead += peeked_length;
+		local_data = buffer;
+	}
+	else if (section_header) {
+		uint8_t* buffer = light_io_reserve(fd, bytesToRead);
+		DCHECK_NULLP(buffer, return LIGHT_OUT_OF_MEMORY);
 		// We already took the magic number
-		memcpy(local_data, &byte_order_magic, 4);
-		bytesRead = light_io_read(fd, local_data + 4, bytesToRead - 4);
+		memcpy(buffer, &byte_order_magic, 4);
+		bytesRead = light_io_read(fd, buffer + 4, bytesToRead - 4);
 		bytesRead += 4;
+		local_data = buffer;
 	}
 	else
 	{
-		bytesRead = light_io_read(fd, local_data, bytesToRead);
+		uint8_t* buffer = light_io_reserve(fd, bytesToRead);
+		DCHECK_NULLP(buffer, return LIGHT_OUT_OF_MEMORY);
+		bytesRead = light_io_read(fd, buffer, bytesToRead);
+		local_data = buffer;
 	}
 	if (bytesRead != bytesToRead)
 	{
-		goto failed;
+		return LIGHT_FAILURE;
 	}
 
-	//Need to move file to next record so read the footer, which is just the record length repeated
-	bytesRead = light_io_read(fd, &blockSize, sizeof(blockSize));
-	if (*swap_endianness) blockSize = bswap32(blockSize);
 	//Verify the two sizes match!!
-	if (blockSize != current->total_length || bytesRead != sizeof(blockSize))
+	memcpy(&blockSize, local_data + bodySize, sizeof(blockSize));
+	if (*swap_endianness) blockSize = bswap32(blockSize);
+	if (blockSize != bodySize + 3 * sizeof(uint32_t))
 	{
-		goto failed;
+		return LIGHT_FAILURE;
 	}
 
-	parse_by_type(current, local_data, *swap_endianness);
+	uint32_t options_offset = __options_offset(blockType, local_data, bodySize, *swap_endianness);
 
-	free(local_data);
-	*block = current;
-	return;
+	view->type = blockType;
+	view->total_length = blockSize;
+	view->body = local_data;
+	view->body_length = bodySize;
+	view->options = local_data + options_offset;
+	view->options_length = bodySize - options_offset;
 
-failed:
-	// An unexpected EOF took place, or memory allocation failed
-	free(current);
-	free(local_data);
+	return LIGHT_SUCCESS;
 }
 
-static void __free_option(light_option option)
+int light_read_block_view_truncated(light_file fd, uint32_t max_data, light_block_view* view, bool* swap_endianness)
+{
+	DCHECK_NULLP(view, return LIGHT_INVALID_ARGUMENT);
+
+	uint32_t blockType, blockSize;
+	int res = light_peek_block_header(fd, &blockType, &blockSize, swap_endianness);
+	if (res != LIGHT_SUCCESS) {
+		return res;
+	}
+
+	uint32_t header_size;
+	switch (blockType)
+	{
+	case LIGHT_ENHANCED_PACKET_BLOCK:
+		header_size = sizeof(struct _light_enhanced_packet_block);
+		break;
+	case LIGHT_SIMPLE_PACKET_BLOCK:
+		header_size = sizeof(struct _light_simple_packet_block);
+		break;
+	default:
+		return light_read_block_view(fd, view, swap_endianness);
+	}
+
+	uint32_t bodySize = blockSize - 3 * sizeof(uint32_t);
+	uint32_t bytesToRead = bodySize + sizeof(uint32_t);
+	const uint8_t* body;
+	uint32_t available;
+	res = light_peek_block_body(fd, header_size, &body, &available, swap_endianness);
+	if (res != LIGHT_SUCCESS) {
+		return res;
+	}
+	if (available < header_size || fd->peeked_body_length == bytesToRead) {
+		// Malformed, or borrowed as a whole already and nothing left to save
+		return light_read_block_view(fd, view, swap_endianness);
+	}
+
+	// Simple packet blocks have no options, the data runs to the end of the body
+	uint32_t options_offset = blockType == LIGHT_ENHANCED_PACKET_BLOCK
+		? __options_offset(blockType, body, bodySize, *swap_endianness)
+		: bodySize;
+	uint32_t keep = (uint32_t)MIN((uint64_t)header_size + max_data, (uint64_t)options_offset);
+	keep = MAX(keep, fd->peeked_body_length);
+	if (keep >= options_offset) {
+		return light_read_block_view(fd, view, swap_endianness);
+	}
+
+	res = light_peek_block_body(fd, keep, &body, &available, swap_endianness);
+	if (res != LIGHT_SUCCESS) {
+		return res;
+	}
+	fd->peeked = false;
+	fd->peeked_body_length = 0;
+
+	res = __skip_bytes(fd, options_offset - keep, keep);
+	if (res != LIGHT_SUCCESS) {
+		return res;
+	}
+
+	// Options and trailer go right behind the data we kept
+	uint32_t rest = bytesToRead - options_offset;
+	uint8_t* buffer = light_io_grow(fd, (size_t)keep + rest, keep);
+	DCHECK_NULLP(buffer, return LIGHT_OUT_OF_MEMORY);
+	if (light_io_read(fd, buffer + keep, rest) != rest) {
+		return LIGHT_FAILURE;
+	}
+
+	uint32_t trailer;
+	memcpy(&trailer, buffer + keep + rest - sizeof(trailer), sizeof(trailer));
+	if (*swap_endianness) trailer = bswap32(trailer);
+	if (trailer != blockSize)
+	{
+		return LIGHT_FAILURE;
+	}
+
+	view->type = blockType;
+	view->total_length = blockSize;
+	view->body = buffer;
+	view->body_length = keep + rest - sizeof(trailer);
+	view->options = buffer + keep;
+	view->options_length = rest - sizeof(trailer);
+
+	return LIGHT_SUCCESS;
+}
+
+/// <summary>
+/// Returns a full record as read out of the file
+/// </summary>
+/// <param name="fd">File to read from</param>
+/// <returns>The block read from the file - may contain sub blocks</returns>
+void light_read_block(light_file fd, light_block* block, bool* swap_endianness)
 {
-	if (option == NULL)
+	if (block && *block) {
+		light_free_block(*block);
+	}
+	*block = NULL;
+
+	light_block_view view;
+	if (light_read_block_view(fd, &view, swap_endianness) != LIGHT_SUCCESS) {
+		// EOF or malformed block, we did not allocate anything
 		return;
+	}
 
-	__free_option(option->next_option);
+	*block = light_block_from_view(&view, *swap_endianness);
+}
 
-	option->next_option = NULL;
-	free(option->data);
-	free(option);
+light_block light_block_from_view(const light_block_view* view, const bool swap_endianness)
+{
+	light_block current = calloc(1, sizeof(struct light_block_t));
+	DCHECK_NULLP(current, return NULL);
+
+	current->type = view->type;
+	current->total_length = view->total_length;
+	parse_by_type(current, view->body, swap_endianness);
+
+	return current;
+}
+
+static void __free_option(light_option option)
+{
+	while (option != NULL) {
+		light_option next = option->next_option;
+		free(option->data);
+		free(option);
+		option = next;
+	}
 }
 
 void light_free_block(light_block block)
@@ -416,49 +709,48 @@ void light_free_block(light_block block)
 	}
 }
 
-uint32_t* __options_to_mem(const light_option option, size_t* size)
+// Serialized size of an option list
+static size_t __options_size(const struct light_option_t* option)
 {
-	if (option == NULL) {
-		*size = 0;
-		return NULL;
+	size_t size = 0;
+	for (; option != NULL; option = option->next_option) {
+		size_t current_size = 0;
+		PADD32(option->length, &current_size);
+		size += sizeof(option->code) + sizeof(option->length) + current_size;
 	}
+	return size;
+}
 
-	size_t next_size;
-	uint32_t* next_option = __options_to_mem(option->next_option, &next_size);
-	uint32_t* current_mem;
-	size_t current_size = 0;
-
-	PADD32(option->length, &current_size);
-
-	current_mem = calloc(sizeof(uint32_t) + current_size + next_size, 1);
-	current_mem[0] = option->code | (option->length << 16);
-	memcpy(&current_mem[1], option->data, current_size);
-	memcpy(&current_mem[1 + current_size / 4], next_option, next_size);
-
-	current_size += sizeof(option->code) + sizeof(option->length) + next_size;
-	*size = current_size;
-
-	free(next_option);
-
-	return current_mem;
+// Serializes an option list into mem, returns the end of what was written
+static uint8_t* __options_to_mem(const struct light_option_t* option, uint8_t* mem)
+{
+	for (; option != NULL; option = option->next_option) {
+		size_t current_size = 0;
+		PADD32(option->length, &current_size);
+		uint32_t header = option->code | ((uint32_t)option->length << 16);
+		memcpy(mem, &header, sizeof(header));
+		if (current_size > 0) {
+			memcpy(mem + sizeof(header), option->data, current_size);
+		}
+		mem += sizeof(header) + current_size;
+	}
+	return mem;
 }
 
 size_t light_write_block(light_file file, const light_block block)
 {
-	size_t body_length = block->total_length - 12; // 2 lengths and type
-	size_t options_length = 0;
-	uint32_t* options_mem = __options_to_mem(block->options, &options_length);
-	body_length -= options_length;
-
-	light_io_write(file, &block->type, sizeof(block->type));
-	light_io_write(file, &block->total_length, sizeof(block->total_length));
-
-	light_io_write(file, block->body, body_length);
-	light_io_write(file, options_mem, options_length);
+	size_t options_length = __options_size(block->options);
+	size_t body_length = block->total_length - 12 - options_length; // 2 lengths and type
 
-	light_io_write(file, &block->total_length, sizeof(block->total_length));
+	// Whole block in the file buffer, written at once
+	uint8_t* mem = light_io_reserve(file, block->total_length);
+	DCHECK_NULLP(mem, return 0);
 
-	free(options_mem);
+	memcpy(mem, &block->type, sizeof(block->type));
+	memcpy(mem + 4, &block->total_length, sizeof(block->total_length));
+	memcpy(mem + 8, block->body, body_length);
+	uint8_t* end = __options_to_mem(block->options, mem + 8 + body_length);
+	memcpy(end, &block->total_length, sizeof(block->total_length));
 
-	return block->total_length;
+	return light_io_write(file, mem, block->total_length);
 }
@@ -24,26 +24,21 @@
 #include "light_io.h"
 #include "light_debug.h"
 #include "light_util.h"
+#include "light_internal.h"
+#include "light_io_internal.h"
+#include "light_pcapng_ext_internal.h"
+#include "light_byteorder.h"
 
 #include <stdlib.h>
 #include <string.h>
 
 #include "endianness.h"
 
+#define MIN(x, y) (((x) < (y)) ? (x) : (y))
+#define MAX(x, y) (((x) > (y)) ? (x) : (y))
 
-struct light_pcapng_t
-{
-	light_file file;
-
-	light_pcapng_file_info* file_info;
-	light_block current;
-
-	size_t interfaces_count;
-	light_packet_interface* interfaces;
-	uint32_t section_interface_offset;
-
-	bool swap_endianness;
-};
+#define BATCH_MIN_STORAGE 65536
+#define RESYNC_WINDOW (4 * 1024 * 1024)
 
 char* __alloc_option_string(light_block pcapng, uint16_t option_code) {
 
@@ -84,18 +79,158 @@ static light_pcapng_file_info* __create_file_info(light_block block)
 	return file_info;
 }
 
-static uint64_t __power_of(uint64_t x, uint64_t y)
+#define NSEC_PER_SEC 1000000000ULL
+#define DEFAULT_RESOLUTION 1000000ULL
+
+static const uint64_t __powers_of_10[] = {
+	1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+	10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+	1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL,
+};
+#define POWERS_OF_10 (sizeof(__powers_of_10) / sizeof(__powers_of_10[0]))
+
+// if_tsresol: the high bit picks a power of 2, else a power of 10 (RFC section 4.2)
+static uint64_t __tsresol_resolution(uint8_t tsresol)
 {
-	int i;
-	uint64_t res = 1;
+	uint8_t exponent = tsresol & 0x7F;
+	if (tsresol & 0x80) {
+		return exponent < 64 ? (uint64_t)1 << exponent : DEFAULT_RESOLUTION;
+	}
+	return exponent < POWERS_OF_10 ? __powers_of_10[exponent] : DEFAULT_RESOLUTION;
+}
 
-	for (i = 0; i < y; i++)
-		res *= x;
+// if_tsresol for a resolution, the next power of 10 when it is neither a power of 10 nor of 2
+static uint8_t __resolution_tsresol(uint64_t resolution)
+{
+	if ((resolution & (resolution - 1)) == 0 && resolution > 1) {
+		uint8_t exponent = 0;
+		while (((uint64_t)1 << exponent) != resolution) {
+			exponent++;
+		}
+		// Powers of 10 are preferred, the only power of 2 that is one as well is 1
+		return 0x80 | exponent;
+	}
+	uint8_t exponent = 0;
+	while (exponent + 1 < POWERS_OF_10 && __powers_of_10[exponent] < resolution) {
+		exponent++;
+	}
+	return exponent;
+}
 
-	return res;
+light_clock light_make_clock(uint64_t resolution)
+{
+	light_clock clock = { 0 };
+	clock.resolution = resolution ? resolution : DEFAULT_RESOLUTION;
+	clock.kind = LIGHT_CLOCK_GENERIC;
+	if (clock.resolution == DEFAULT_RESOLUTION) {
+		clock.kind = LIGHT_CLOCK_MICRO;
+	}
+	else if (clock.resolution == NSEC_PER_SEC) {
+		clock.kind = LIGHT_CLOCK_NANO;
+	}
+	else if (clock.resolution < NSEC_PER_SEC && NSEC_PER_SEC % clock.resolution == 0) {
+		clock.kind = LIGHT_CLOCK_DIVISOR;
+		clock.nsec_per_tick = NSEC_PER_SEC / clock.resolution;
+	}
+	else if ((clock.resolution & (clock.resolution - 1)) == 0) {
+		while (((uint64_t)1 << clock.shift) != clock.resolution) {
+			clock.shift++;
+		}
+		// Fractions below 2^33 times 10^9 stay below 2^63
+		if (clock.shift <= 33) {
+			clock.kind = LIGHT_CLOCK_POW2;
+		}
+	}
+	return clock;
 }
 
-static void __append_interface_block(light_pcapng pcapng, const light_block interface_block, const bool swap_endian)
+struct timespec light_clock_timespec(const light_clock* clock, uint64_t ticks)
+{
+	uint64_t secs, nsecs;
+	switch (clock->kind)
+	{
+	case LIGHT_CLOCK_MICRO:
+		// Constant divisors, compiled to multiplications
+		secs = ticks / DEFAULT_RESOLUTION;
+		nsecs = (ticks % DEFAULT_RESOLUTION) * 1000;
+		break;
+	case LIGHT_CLOCK_NANO:
+		secs = ticks / NSEC_PER_SEC;
+		nsecs = ticks % NSEC_PER_SEC;
+		break;
+	case LIGHT_CLOCK_DIVISOR:
+		secs = ticks / clock->resolution;
+		nsecs = (ticks - secs * clock->resolution) * clock->nsec_per_tick;
+		break;
+	case LIGHT_CLOCK_POW2:
+		secs = ticks >> clock->shift;
+		nsecs = ((ticks & (clock->resolution - 1)) * NSEC_PER_SEC) >> clock->shift;
+		break;
+	default:
+		secs = ticks / clock->resolution;
+		nsecs = ticks % clock->resolution;
+		nsecs = clock->resolution <= UINT64_MAX / NSEC_PER_SEC
+			? nsecs * NSEC_PER_SEC / clock->resolution
+			: (uint64_t)((double)nsecs * (double)NSEC_PER_SEC / (double)clock->resolution);
+		break;
+	}
+
+	struct timespec ts;
+	ts.tv_sec = (time_t)secs;
+	ts.tv_nsec = (long)nsecs;
+	return ts;
+}
+
+uint64_t light_clock_ticks(const light_clock* clock, struct timespec timestamp)
+{
+	uint64_t secs = (uint64_t)timestamp.tv_sec;
+	uint64_t nsecs = (uint64_t)timestamp.tv_nsec;
+	switch (clock->kind)
+	{
+	case LIGHT_CLOCK_MICRO:
+		return secs * DEFAULT_RESOLUTION + nsecs / 1000;
+	case LIGHT_CLOCK_NANO:
+		return secs * NSEC_PER_SEC + nsecs;
+	case LIGHT_CLOCK_DIVISOR:
+		return secs * clock->resolution + nsecs / clock->nsec_per_tick;
+	case LIGHT_CLOCK_POW2:
+		return (secs << clock->shift) + (nsecs << clock->shift) / NSEC_PER_SEC;
+	default:
+		return secs * clock->resolution + (clock->resolution <= UINT64_MAX / NSEC_PER_SEC
+			? nsecs * clock->resolution / NSEC_PER_SEC
+			: (uint64_t)((double)nsecs * (double)clock->resolution / (double)NSEC_PER_SEC));
+	}
+}
+
+static const light_clock __default_clock = { DEFAULT_RESOLUTION, LIGHT_CLOCK_MICRO, 0, 0 };
+
+const light_clock* light_pcapng_clock(light_pcapng pcapng, uint32_t interface_id)
+{
+	if (interface_id >= pcapng->interfaces_count) {
+		// Default value in case of corrupt PCAPNG without interface
+		return &__default_clock;
+	}
+	uint64_t resolution = pcapng->interfaces[interface_id].timestamp_resolution;
+	resolution = resolution ? resolution : DEFAULT_RESOLUTION;
+	if (interface_id < pcapng->clocks_count && pcapng->clocks[interface_id].resolution == resolution) {
+		return &pcapng->clocks[interface_id];
+	}
+
+	// Interfaces handed over without going through __append_interface_block
+	if (interface_id >= pcapng->clocks_count) {
+		light_clock* clocks = realloc(pcapng->clocks, sizeof(light_clock) * pcapng->interfaces_count);
+		DCHECK_NULLP(clocks, return &__default_clock);
+		for (size_t i = pcapng->clocks_count; i < pcapng->interfaces_count; i++) {
+			clocks[i] = light_make_clock(pcapng->interfaces[i].timestamp_resolution);
+		}
+		pcapng->clocks = clocks;
+		pcapng->clocks_count = pcapng->interfaces_count;
+	}
+	pcapng->clocks[interface_id] = light_make_clock(resolution);
+	return &pcapng->clocks[interface_id];
+}
+
+static int __append_interface_block(light_pcapng pcapng, const light_block interface_block, const bool swap_endian)
 {
 	struct _light_interface_description_block* idb = (struct _light_interface_description_block*)interface_block->body;
 	// no endianness conversion here because idb was already fixed
@@ -108,26 +243,62 @@ static void __append_interface_block(light_pcapng pcapng, const light_block inte
 	lif.description = __alloc_option_string(interface_block, 3);
 
 	ts_resolution_option = light_find_option(interface_block, LIGHT_OPTION_IF_TSRESOL);
-	if (ts_resolution_option && ts_resolution_option->length == sizeof(int8_t))
+	if (ts_resolution_option && ts_resolution_option->length == sizeof(uint8_t))
 	{
-		int8_t tsresol = *((int8_t*)ts_resolution_option->data);
-		if (tsresol >= 0)
-		{
-			lif.timestamp_resolution = __power_of(10, tsresol);
-		}
-		else
-		{
-			lif.timestamp_resolution = __power_of(2, -tsresol);
-		}
+		lif.timestamp_resolution = __tsresol_resolution(*ts_resolution_option->data);
 	}
 	else
 	{
-		lif.timestamp_resolution = 1000000;
+		lif.timestamp_resolution = DEFAULT_RESOLUTION;
 	}
 
-	pcapng->interfaces = realloc(pcapng->interfaces, sizeof(lif) * (pcapng->interfaces_count + 1));
+	light_packet_interface* interfaces = realloc(pcapng->interfaces, sizeof(lif) * (pcapng->interfaces_count + 1));
+	DCHECK_NULLP(interfaces, { free(lif.name); free(lif.description); return LIGHT_OUT_OF_MEMORY; });
+	pcapng->interfaces = interfaces;
 	pcapng->interfaces[pcapng->interfaces_count] = lif;
 	pcapng->interfaces_count++;
+	// Conversions are worked out here once instead of on every packet
+	light_pcapng_clock(pcapng, (uint32_t)pcapng->interfaces_count - 1);
+	return LIGHT_SUCCESS;
+}
+
+int light_pcapng_track_block(light_pcapng pcapng, const light_block_view* view)
+{
+	if (view->type == LIGHT_SECTION_HEADER_BLOCK) {
+		pcapng->section_interface_offset = (uint32_t)pcapng->interfaces_count;
+		// The byte order was just taken from the section header
+		light_pcapng_set_byte_order(pcapng, pcapng->swap_endianness);
+	}
+	if (view->type == LIGHT_INTERFACE_BLOCK) {
+		light_block block = light_block_from_view(view, pcapng->swap_endianness);
+		DCHECK_NULLP(block, return LIGHT_OUT_OF_MEMORY);
+		int res = __append_interface_block(pcapng, block, pcapng->swap_endianness);
+		light_free_block(block);
+		return res;
+	}
+	return LIGHT_SUCCESS;
+}
+
+void light_pcapng_clear_interfaces(light_pcapng pcapng)
+{
+	for (size_t i = 0; i < pcapng->interfaces_count; i++)
+	{
+		light_packet_interface lif = pcapng->interfaces[i];
+		free(lif.name);
+		free(lif.description);
+	}
+	free(pcapng->interfaces);
+	pcapng->interfaces = NULL;
+	pcapng->interfaces_count = 0;
+	pcapng->section_interface_offset = 0;
+	free(pcapng->clocks);
+	pcapng->clocks = NULL;
+	pcapng->clocks_count = 0;
+	free(pcapng->interface_table);
+	pcapng->interface_table = NULL;
+	pcapng->interface_table_size = 0;
+	pcapng->interface_table_start = 0;
+	pcapng->interface_table_count = 0;
 }
 
 int light_pcapng_init(light_pcapng pcapng, light_pcapng_file_info* file_info)
@@ -188,8 +359,9 @@ light_pcapng light_pcapng_create(light_file file, const char* mode, light_pcapng
 	bool update = strstr(mode, "+") != NULL;
 
 	light_pcapng pcapng = calloc(1, sizeof(struct light_pcapng_t));
-	pcapng->swap_endianness = false;
+	light_pcapng_set_byte_order(pcapng, false);
 	pcapng->file = file;
+	pcapng->snaplen = LIGHT_SNAPLEN_UNLIMITED;
 
 	bool* swap_endianness = &(pcapng->swap_endianness);
 
@@ -198,6 +370,7 @@ light_pcapng light_pcapng_create(light_file file, const char* mode, light_pcapng
 		//When the file is opened we need to go ahead and read that out
 		light_block section = NULL;
 		light_read_block(pcapng->file, &section, swap_endianness);
+		light_pcapng_set_byte_order(pcapng, pcapng->swap_endianness);
 		//Prase stuff out of the section header
 		pcapng->file_info = __create_file_info(section);
 		light_free_block(section);
@@ -209,20 +382,22 @@ light_pcapng light_pcapng_create(light_file file, const char* mode, light_pcapng
 	if (append && update)
 	{
 		light_block block = NULL;
+		// go to beginning of file
+		light_io_seek(file, 0, SEEK_SET);
 		while (1)
 		{
-			// go to beginning of file
-			light_io_seek(file, 0, SEEK_SET);
 			light_read_block(pcapng->file, &block, swap_endianness);
 			if (block == NULL) {
 				return pcapng;
 			}
 			if (block->type == LIGHT_SECTION_HEADER_BLOCK) {
-				pcapng->section_interface_offset = pcapng->interfaces_count;
+				pcapng->section_interface_offset = (uint32_t)pcapng->interfaces_count;
 			}
 			if (block->type == LIGHT_INTERFACE_BLOCK) {
 				__append_interface_block(pcapng, block, *swap_endianness);
 			}
+			light_free_block(block);
+			block = NULL;
 		}
 	}
 
@@ -320,118 +495,507 @@ void __get_interface(light_pcapng pcapng, size_t index, light_packet_interface*
 	// Corrupt PCAPNG
 }
 
-int light_read_packet(light_pcapng pcapng, light_packet_interface* packet_interface, light_packet_header* packet_header, const uint8_t** packet_data)
+void light_pcapng_set_read_flags(light_pcapng pcapng, uint32_t flags)
+{
+	DCHECK_NULLP(pcapng, return);
+	pcapng->read_flags = flags;
+}
+
+void light_pcapng_set_snaplen(light_pcapng pcapng, uint32_t snaplen)
+{
+	DCHECK_NULLP(pcapng, return);
+	pcapng->snaplen = snaplen;
+}
+
+int light_pcapng_set_filter(light_pcapng pcapng, const light_packet_filter* filter)
 {
 	DCHECK_NULLP(pcapng, return LIGHT_INVALID_ARGUMENT);
-	DCHECK_NULLP(packet_interface, return LIGHT_INVALID_ARGUMENT);
-	DCHECK_NULLP(packet_header, return LIGHT_INVALID_ARGUMENT);
-	DCHECK_NULLP(packet_data, return LIGHT_INVALID_ARGUMENT);
 
-	if (pcapng->file == NULL) {
-		return LIGHT_INVALID_ARGUMENT;
+	free((uint32_t*)pcapng->filter.interface_ids);
+	pcapng->filter = (const light_packet_filter){ 0 };
+	pcapng->filtered = false;
+
+	if (filter == NULL) {
+		return LIGHT_SUCCESS;
 	}
 
-	light_free_block(pcapng->current);
-	pcapng->current = NULL;
-	light_block block = NULL;
-	while (1)
-	{
-		light_read_block(pcapng->file, &block, &(pcapng->swap_endianness));
-		if (block == NULL) {
-			//End of file or something is broken
-			return LIGHT_FAILURE;
+	uint32_t* interface_ids = NULL;
+	if (filter->interface_count > 0) {
+		DCHECK_NULLP(filter->interface_ids, return LIGHT_INVALID_ARGUMENT);
+		interface_ids = malloc(filter->interface_count * sizeof(uint32_t));
+		DCHECK_NULLP(interface_ids, return LIGHT_OUT_OF_MEMORY);
+		memcpy(interface_ids, filter->interface_ids, filter->interface_count * sizeof(uint32_t));
+	}
+
+	pcapng->filter = *filter;
+	pcapng->filter.interface_ids = interface_ids;
+	pcapng->filtered = true;
+
+	return LIGHT_SUCCESS;
+}
+
+struct timespec light_pcapng_timestamp(light_pcapng pcapng, uint32_t interface_id, uint64_t timestamp)
+{
+	return light_clock_timespec(light_pcapng_clock(pcapng, interface_id), timestamp);
+}
+
+static int __timespec_compare(const struct timespec* a, const struct timespec* b)
+{
+	if (a->tv_sec != b->tv_sec) {
+		return a->tv_sec < b->tv_sec ? -1 : 1;
+	}
+	if (a->tv_nsec != b->tv_nsec) {
+		return a->tv_nsec < b->tv_nsec ? -1 : 1;
+	}
+	return 0;
+}
+
+static bool __filter_match(const light_packet_filter* filter, uint32_t interface_id, const struct timespec* timestamp, uint32_t captured_length)
+{
+	if (filter->interface_count > 0) {
+		size_t i = 0;
+		while (i < filter->interface_count && filter->interface_ids[i] != interface_id) {
+			i++;
 		}
-		if (block->type == LIGHT_ENHANCED_PACKET_BLOCK || block->type == LIGHT_SIMPLE_PACKET_BLOCK)
-		{
-			break;
+		if (i == filter->interface_count) {
+			return false;
 		}
-		if (block->type == LIGHT_SECTION_HEADER_BLOCK) {
-			pcapng->section_interface_offset = pcapng->interfaces_count;
-			continue;
+	}
+
+	if (__timespec_compare(timestamp, &filter->start) < 0) {
+		return false;
+	}
+	if ((filter->end.tv_sec != 0 || filter->end.tv_nsec != 0) && __timespec_compare(timestamp, &filter->end) >= 0) {
+		return false;
+	}
+
+	if (captured_length < filter->min_captured_length) {
+		return false;
+	}
+	if (filter->max_captured_length != 0 && captured_length > filter->max_captured_length) {
+		return false;
+	}
+
+	return true;
+}
+
+// Checks the filter on the fixed part of a pending packet block, only that part is read
+static int __filter_packet_block(light_pcapng pcapng, uint32_t type, uint32_t length, bool* match)
+{
+	uint32_t header_size = type == LIGHT_ENHANCED_PACKET_BLOCK
+		? sizeof(struct _light_enhanced_packet_block)
+		: sizeof(struct _light_simple_packet_block);
+	const uint8_t* body;
+	uint32_t available;
+	int res = light_peek_block_body(pcapng->file, header_size, &body, &available, &(pcapng->swap_endianness));
+	if (res != LIGHT_SUCCESS) {
+		return res;
+	}
+
+	uint32_t data_length = length - 3 * sizeof(uint32_t);
+	data_length = data_length >= header_size ? data_length - header_size : 0;
+	uint32_t interface_id = pcapng->section_interface_offset;
+	struct timespec timestamp = { 0 };
+	uint32_t captured_length = 0;
+
+	// Same rules as __parse_packet_block_native, a truncated header reads as zeroes
+	if (type == LIGHT_ENHANCED_PACKET_BLOCK)
+	{
+		struct _light_enhanced_packet_block epb = { 0 };
+		if (available >= sizeof(epb)) {
+			memcpy(&epb, body, sizeof(epb));
 		}
-		if (block->type == LIGHT_INTERFACE_BLOCK) {
-			__append_interface_block(pcapng, block, pcapng->swap_endianness);
-			continue;
+		fix_endianness_enhanced_packet_block(&epb, pcapng->swap_endianness);
+
+		interface_id += epb.interface_id;
+		timestamp = light_pcapng_timestamp(pcapng, interface_id, ((uint64_t)epb.timestamp_high << 32) + epb.timestamp_low);
+		captured_length = MIN(epb.capture_packet_length, data_length);
+	}
+	else
+	{
+		struct _light_simple_packet_block spb = { 0 };
+		if (available >= sizeof(spb)) {
+			memcpy(&spb, body, sizeof(spb));
 		}
+		fix_endianness_simple_packet_block(&spb, pcapng->swap_endianness);
+
+		captured_length = MIN(spb.original_packet_length, data_length);
 	}
 
-	*packet_data = NULL;
+	*match = __filter_match(&pcapng->filter, interface_id, &timestamp, captured_length);
+	return LIGHT_SUCCESS;
+}
 
-	if (block->type == LIGHT_ENHANCED_PACKET_BLOCK)
+static char* __read_comment(light_pcapng pcapng, const uint8_t* comment, uint16_t comment_length)
+{
+	if (comment == NULL)
 	{
-		struct _light_enhanced_packet_block* epb = (struct _light_enhanced_packet_block*)block->body;
-		// no endianness fix needed since fixed before
-
-		packet_header->captured_length = epb->capture_packet_length;
-		packet_header->original_length = epb->original_capture_length;
-		uint64_t timestamp = epb->timestamp_high;
-		timestamp = timestamp << 32;
-		timestamp += epb->timestamp_low;
+		return NULL;
+	}
 
-		__get_interface(pcapng, pcapng->section_interface_offset + epb->interface_id, packet_interface);
-		// Default value in case of corrupt PCAPNG without interface
-		uint64_t ts_res = packet_interface->timestamp_resolution;
-		if (!ts_res)
+	char* comment_string = NULL;
+	if (pcapng->read_flags & LIGHT_READ_BORROWED)
+	{
+		if (pcapng->comment_size < (size_t)comment_length + 1)
 		{
-			ts_res = 1000000;
+			free(pcapng->comment);
+			pcapng->comment = malloc((size_t)comment_length + 1);
+			pcapng->comment_size = pcapng->comment ? (size_t)comment_length + 1 : 0;
+			DCHECK_NULLP(pcapng->comment, return NULL);
 		}
+		comment_string = pcapng->comment;
+	}
+	else
+	{
+		// Caller takes ownership of the comment
+		comment_string = malloc((size_t)comment_length + 1);
+		DCHECK_NULLP(comment_string, return NULL);
+	}
 
-		uint64_t ts_secs = timestamp / ts_res;
-		uint64_t ts_frac = timestamp % ts_res;
-		uint64_t ts_nsec = ts_frac * 1000000000 / ts_res;
+	memcpy(comment_string, comment, comment_length);
+	comment_string[comment_length] = '\0';
 
-		packet_header->timestamp.tv_sec = (time_t)ts_secs;
-		packet_header->timestamp.tv_nsec = (long)ts_nsec;
+	return comment_string;
+}
 
-		packet_header->flags = 0;
-		light_option flags_opt = light_find_option(block, LIGHT_OPTION_EPB_FLAGS);
-		if (flags_opt != NULL && flags_opt->length == sizeof(uint32_t))
-		{
-			packet_header->flags = *(uint32_t*)(flags_opt->data);
-			if (pcapng->swap_endianness) {
-				packet_header->flags = bswap32(packet_header->flags);
+// Reads blocks until the next packet block, keeping track of sections and interfaces on the way
+static int __read_packet_block(light_pcapng pcapng, light_block_view* view)
+{
+	// The view borrows the file buffer, nothing gets allocated for packet blocks
+	while (1)
+	{
+		uint32_t type, length;
+		if (light_peek_block_header(pcapng->file, &type, &length, &(pcapng->swap_endianness)) != LIGHT_SUCCESS) {
+			//End of file or something is broken
+			return LIGHT_FAILURE;
+		}
+		if (type != LIGHT_ENHANCED_PACKET_BLOCK && type != LIGHT_SIMPLE_PACKET_BLOCK
+			&& type != LIGHT_SECTION_HEADER_BLOCK && type != LIGHT_INTERFACE_BLOCK) {
+			// Statistics, name resolution, custom blocks... seek over them unread
+			if (light_skip_block(pcapng->file, &(pcapng->swap_endianness)) != LIGHT_SUCCESS) {
+				return LIGHT_FAILURE;
 			}
+			continue;
 		}
-
-		packet_header->dropcount = 0;
-		light_option dropcount_opt = light_find_option(block, LIGHT_OPTION_EPB_DROPCOUNT);
-		if (dropcount_opt != NULL && dropcount_opt->length != 0)
-		{
-			packet_header->dropcount = *(uint64_t*)(dropcount_opt->data);
-			if (pcapng->swap_endianness) {
-				packet_header->dropcount = bswap64(packet_header->dropcount);
+		if (pcapng->filtered && (type == LIGHT_ENHANCED_PACKET_BLOCK || type == LIGHT_SIMPLE_PACKET_BLOCK)) {
+			bool match = true;
+			if (__filter_packet_block(pcapng, type, length, &match) != LIGHT_SUCCESS) {
+				return LIGHT_FAILURE;
 			}
+			if (!match) {
+				// The payload of rejected packets is never read
+				if (light_skip_block(pcapng->file, &(pcapng->swap_endianness)) != LIGHT_SUCCESS) {
+					return LIGHT_FAILURE;
+				}
+				continue;
+			}
+		}
+		if (light_read_block_view_truncated(pcapng->file, pcapng->snaplen, view, &(pcapng->swap_endianness)) != LIGHT_SUCCESS) {
+			return LIGHT_FAILURE;
+		}
+		if (view->type == LIGHT_ENHANCED_PACKET_BLOCK || view->type == LIGHT_SIMPLE_PACKET_BLOCK)
+		{
+			return LIGHT_SUCCESS;
+		}
+		int res = light_pcapng_track_block(pcapng, view);
+		if (res != LIGHT_SUCCESS) {
+			return res;
 		}
+	}
+}
+
+// Defines __parse_packet_block_<suffix>: indexes the options of a packet block and fills
+// everything but the comment out of it, interface_id indexes pcapng->interfaces
+#define DEFINE_PARSE_PACKET_BLOCK(suffix, SWAP32, SWAP64) \
+static void __parse_packet_block_##suffix(light_pcapng pcapng, const light_block_view* view, light_option_index* options, uint32_t* interface_id, light_packet_header* packet_header, const uint8_t** packet_data) \
+{ \
+	*packet_header = (const light_packet_header){ 0 }; \
+	*packet_data = NULL; \
+	light_index_options_##suffix(options, view); \
+\
+	if (view->type == LIGHT_ENHANCED_PACKET_BLOCK) \
+	{ \
+		struct _light_enhanced_packet_block epb = { 0 }; \
+		uint32_t data_length = 0; \
+		if (view->body_length >= sizeof(epb)) { \
+			light_load_epb_##suffix(&epb, view->body); \
+			data_length = view->body_length - sizeof(epb); \
+		} \
+\
+		packet_header->captured_length = MIN(epb.capture_packet_length, data_length); \
+		packet_header->original_length = epb.original_capture_length; \
+		uint64_t timestamp = epb.timestamp_high; \
+		timestamp = timestamp << 32; \
+		timestamp += epb.timestamp_low; \
+\
+		*interface_id = pcapng->section_interface_offset + epb.interface_id; \
+		packet_header->timestamp_ticks = timestamp; \
+		if (!(pcapng->read_flags & LIGHT_READ_RAW_TIMESTAMPS)) { \
+			packet_header->timestamp = light_pcapng_timestamp(pcapng, *interface_id, timestamp); \
+		} \
+\
+		uint16_t opt_length = 0; \
+		const uint8_t* opt_data = NULL; \
+\
+		opt_data = light_index_find_option(options, LIGHT_OPTION_EPB_FLAGS, &opt_length); \
+		if (opt_data != NULL && opt_length == sizeof(uint32_t)) \
+		{ \
+			memcpy(&packet_header->flags, opt_data, sizeof(uint32_t)); \
+			packet_header->flags = SWAP32(packet_header->flags); \
+		} \
+\
+		opt_data = light_index_find_option(options, LIGHT_OPTION_EPB_DROPCOUNT, &opt_length); \
+		if (opt_data != NULL && opt_length == sizeof(uint64_t)) \
+		{ \
+			memcpy(&packet_header->dropcount, opt_data, sizeof(uint64_t)); \
+			packet_header->dropcount = SWAP64(packet_header->dropcount); \
+		} \
+\
+		opt_data = light_index_find_option(options, LIGHT_OPTION_EPB_QUEUE, &opt_length); \
+		if (opt_data != NULL && opt_length == sizeof(uint32_t)) \
+		{ \
+			memcpy(&packet_header->queue, opt_data, sizeof(uint32_t)); \
+			packet_header->queue = SWAP32(packet_header->queue); \
+		} \
+\
+		*packet_data = view->body + sizeof(epb); \
+	} \
+\
+	if (view->type == LIGHT_SIMPLE_PACKET_BLOCK) \
+	{ \
+		struct _light_simple_packet_block spb = { 0 }; \
+		uint32_t data_length = 0; \
+		if (view->body_length >= sizeof(spb)) { \
+			memcpy(&spb, view->body, sizeof(spb)); \
+			data_length = view->body_length - sizeof(spb); \
+		} \
+		spb.original_packet_length = SWAP32(spb.original_packet_length); \
+\
+		packet_header->captured_length = MIN(spb.original_packet_length, data_length); \
+		packet_header->original_length = spb.original_packet_length; \
+		*interface_id = pcapng->section_interface_offset; \
+		*packet_data = view->body + sizeof(spb); \
+	} \
+\
+	packet_header->captured_length = MIN(packet_header->captured_length, pcapng->snaplen); \
+}
+
+DEFINE_PARSE_PACKET_BLOCK(native, LIGHT_NATIVE32, LIGHT_NATIVE64)
+DEFINE_PARSE_PACKET_BLOCK(swapped, LIGHT_SWAPPED32, LIGHT_SWAPPED64)
+
+void light_pcapng_set_byte_order(light_pcapng pcapng, bool swap_endianness)
+{
+	pcapng->swap_endianness = swap_endianness;
+	pcapng->parse_packet_block = swap_endianness ? __parse_packet_block_swapped : __parse_packet_block_native;
+}
+
+int light_pcapng_next_packet(light_pcapng pcapng, uint32_t* interface_id, light_packet_header* packet_header, const uint8_t** packet_data)
+{
+	light_block_view view;
+	int res = __read_packet_block(pcapng, &view);
+	if (res != LIGHT_SUCCESS) {
+		return res;
+	}
+
+	// One pass over the options, every lookup is constant time
+	light_option_index options;
+	pcapng->parse_packet_block(pcapng, &view, &options, interface_id, packet_header, packet_data);
+
+	uint16_t comment_length = 0;
+	const uint8_t* comment = light_index_find_option(&options, LIGHT_OPTION_COMMENT, &comment_length);
+	packet_header->comment = __read_comment(pcapng, comment, comment_length);
+	packet_header->comment_length = packet_header->comment ? comment_length : 0;
+
+	return LIGHT_SUCCESS;
+}
+
+int light_read_packet(light_pcapng pcapng, light_packet_interface* packet_interface, light_packet_header* packet_header, const uint8_t** packet_data)
+{
+	DCHECK_NULLP(pcapng, return LIGHT_INVALID_ARGUMENT);
+	DCHECK_NULLP(packet_interface, return LIGHT_INVALID_ARGUMENT);
+	DCHECK_NULLP(packet_header, return LIGHT_INVALID_ARGUMENT);
+	DCHECK_NULLP(packet_data, return LIGHT_INVALID_ARGUMENT);
+
+	if (pcapng->file == NULL) {
+		return LIGHT_INVALID_ARGUMENT;
+	}
 
-		packet_header->queue = 0;
-		light_option queue_opt = light_find_option(block, LIGHT_OPTION_EPB_QUEUE);
-		if (queue_opt != NULL && queue_opt->length != 0)
+	uint32_t interface_id = 0;
+	int res = light_pcapng_next_packet(pcapng, &interface_id, packet_header, packet_data);
+	if (res != LIGHT_SUCCESS) {
+		return res;
+	}
+	__get_interface(pcapng, interface_id, packet_interface);
+
+	return LIGHT_SUCCESS;
+}
+
+int light_pcapng_resync(light_pcapng pcapng)
+{
+	DCHECK_NULLP(pcapng, return LIGHT_INVALID_ARGUMENT);
+	DCHECK_NULLP(pcapng->file, return LIGHT_INVALID_ARGUMENT);
+
+	// Start over right after the block that failed, if we can go back there
+	light_file file = pcapng->file;
+	if (file->peeked_offset < 0 || light_io_seek(file, file->peeked_offset + 1, SEEK_SET) < 0) {
+		file->peeked = false;
+		file->peeked_body_length = 0;
+	}
+
+	uint8_t* window = malloc(RESYNC_WINDOW);
+	DCHECK_NULLP(window, return LIGHT_OUT_OF_MEMORY);
+	size_t filled = light_io_read(file, window, RESYNC_WINDOW);
+
+	while (1) {
+		// Only blocks starting in the first half are looked at, so any block
+		// up to half a window is seen whole before the window moves on
+		bool at_end = filled < RESYNC_WINDOW;
+		size_t limit = at_end ? filled : RESYNC_WINDOW / 2;
+		bool swap_endianness = pcapng->swap_endianness;
+		size_t found = light_find_block_range(window, filled, 0, limit, 1, &swap_endianness);
+
+		if (found < limit) {
+			int res = light_io_unread(file, window + found, filled - found) == 0 ? LIGHT_SUCCESS : LIGHT_OUT_OF_MEMORY;
+			light_pcapng_set_byte_order(pcapng, swap_endianness);
+			free(window);
+			return res;
+		}
+		if (at_end) {
+			free(window);
+			return LIGHT_FAILURE;
+		}
+
+		memmove(window, window + limit, filled - limit);
+		filled -= limit;
+		filled += light_io_read(file, window + filled, RESYNC_WINDOW - filled);
+	}
+}
+
+light_packet_batch* light_create_packet_batch(size_t capacity)
+{
+	light_packet_batch* batch = calloc(1, sizeof(light_packet_batch));
+	DCHECK_NULLP(batch, return NULL);
+
+	batch->capacity = capacity;
+	batch->timestamps = calloc(capacity, sizeof(*batch->timestamps));
+	batch->timestamp_ticks = calloc(capacity, sizeof(*batch->timestamp_ticks));
+	batch->captured_lengths = calloc(capacity, sizeof(*batch->captured_lengths));
+	batch->original_lengths = calloc(capacity, sizeof(*batch->original_lengths));
+	batch->interface_ids = calloc(capacity, sizeof(*batch->interface_ids));
+	batch->flags = calloc(capacity, sizeof(*batch->flags));
+	batch->packet_data = calloc(capacity, sizeof(*batch->packet_data));
+
+	if (!batch->timestamps || !batch->timestamp_ticks || !batch->captured_lengths || !batch->original_lengths ||
+		!batch->interface_ids || !batch->flags || !batch->packet_data)
+	{
+		light_free_packet_batch(batch);
+		return NULL;
+	}
+
+	return batch;
+}
+
+void light_free_packet_batch(light_packet_batch* batch)
+{
+	if (batch != NULL) {
+		free(batch->timestamps);
+		free(batch->timestamp_ticks);
+		free(batch->captured_lengths);
+		free(batch->original_lengths);
+		free(batch->interface_ids);
+		free(batch->flags);
+		free((void*)batch->packet_data);
+		free(batch);
+	}
+}
+
+// Copies packet data that would be overwritten by the next block read into the batch storage
+static const uint8_t* __store_batch_data(light_pcapng pcapng, light_packet_batch* batch, const uint8_t* data, uint32_t length)
+{
+	if (!light_io_in_buffer(pcapng->file, data)) {
+		// Backend memory, it outlives the batch
+		return data;
+	}
+
+	size_t needed = pcapng->batch_used + length;
+	if (needed > pcapng->batch_size || pcapng->batch_data == NULL)
+	{
+		size_t new_size = MAX(needed, MAX(2 * pcapng->batch_size, BATCH_MIN_STORAGE));
+		uintptr_t old_data = (uintptr_t)pcapng->batch_data;
+		uint8_t* new_data = realloc(pcapng->batch_data, new_size);
+		DCHECK_NULLP(new_data, return NULL);
+
+		// Move what this batch already stored along with the storage
+		for (size_t i = 0; i < batch->count; i++)
 		{
-			packet_header->queue = *(uint32_t*)(queue_opt->data);
-			if (pcapng->swap_endianness) {
-				packet_header->queue = bswap32(packet_header->queue);
+			uintptr_t ptr = (uintptr_t)batch->packet_data[i];
+			if (ptr >= old_data && ptr < old_data + pcapng->batch_used) {
+				batch->packet_data[i] = new_data + (ptr - old_data);
 			}
 		}
+		pcapng->batch_data = new_data;
+		pcapng->batch_size = new_size;
+	}
+
+	uint8_t* stored = pcapng->batch_data + pcapng->batch_used;
+	memcpy(stored, data, length);
+	pcapng->batch_used += length;
+
+	return stored;
+}
 
-		*packet_data = epb->packet_data;
+int light_read_packets(light_pcapng pcapng, light_packet_batch* batch, size_t max)
+{
+	DCHECK_NULLP(pcapng, return LIGHT_INVALID_ARGUMENT);
+	DCHECK_NULLP(batch, return LIGHT_INVALID_ARGUMENT);
+
+	if (pcapng->file == NULL) {
+		return LIGHT_INVALID_ARGUMENT;
 	}
 
-	if (block->type == LIGHT_SIMPLE_PACKET_BLOCK)
+	max = MIN(max, batch->capacity);
+	batch->count = 0;
+	pcapng->batch_used = 0;
+
+	while (batch->count < max)
 	{
-		struct _light_simple_packet_block* spb = (struct _light_simple_packet_block*)block->body;
-		// no endianness fix needed since fixed before
+		light_block_view view;
+		if (__read_packet_block(pcapng, &view) != LIGHT_SUCCESS) {
+			break;
+		}
 
-		*packet_header = (const light_packet_header){ 0 };
-		packet_header->captured_length = spb->original_packet_length;
-		packet_header->original_length = spb->original_packet_length;
-		__get_interface(pcapng, pcapng->section_interface_offset, packet_interface);
-		*packet_data = spb->packet_data;
+		light_option_index options;
+		uint32_t interface_id = 0;
+		light_packet_header packet_header;
+		const uint8_t* packet_data = NULL;
+		pcapng->parse_packet_block(pcapng, &view, &options, &interface_id, &packet_header, &packet_data);
+
+		packet_data = __store_batch_data(pcapng, batch, packet_data, packet_header.captured_length);
+		DCHECK_NULLP(packet_data, return LIGHT_OUT_OF_MEMORY);
+
+		size_t i = batch->count;
+		batch->timestamps[i] = packet_header.timestamp;
+		batch->timestamp_ticks[i] = packet_header.timestamp_ticks;
+		batch->captured_lengths[i] = packet_header.captured_length;
+		batch->original_lengths[i] = packet_header.original_length;
+		batch->interface_ids[i] = interface_id;
+		batch->flags[i] = packet_header.flags;
+		batch->packet_data[i] = packet_data;
+		batch->count++;
 	}
 
-	packet_header->comment = __alloc_option_string(block, LIGHT_OPTION_COMMENT);
+	return (int)batch->count;
+}
 
-	pcapng->current = block;
+int light_get_interface(light_pcapng pcapng, uint32_t interface_id, light_packet_interface* packet_interface)
+{
+	DCHECK_NULLP(pcapng, return LIGHT_INVALID_ARGUMENT);
+	DCHECK_NULLP(packet_interface, return LIGHT_INVALID_ARGUMENT);
 
+	if (interface_id >= pcapng->interfaces_count) {
+		return LIGHT_INVALID_ARGUMENT;
+	}
+	*packet_interface = pcapng->interfaces[interface_id];
 	return LIGHT_SUCCESS;
 }
 
@@ -442,26 +1006,21 @@ int safe_strcmp(char const* str1, char const* str2) {
 	return strcmp(str1, str2);
 }
 
-uint8_t get_timestamp_resolution_precision(uint64_t timestamp_resolution) {
-	uint64_t time_value = timestamp_resolution;
-	uint8_t precision = 0;
-	while (time_value > 1) {
-		time_value = time_value / 10;
-		precision = precision + 1;
-	}
-	return precision;
-}
-
 int light_write_interface_block(light_pcapng pcapng, const light_packet_interface * packet_interface)
 {
+        DCHECK_NULLP(pcapng, return LIGHT_INVALID_ARGUMENT);
+        DCHECK_NULLP(pcapng->file, return LIGHT_INVALID_ARGUMENT);
+        DCHECK_NULLP(packet_interface, return LIGHT_INVALID_ARGUMENT);
+
         struct _light_interface_description_block interface_block = { 0 };
         interface_block.link_type = packet_interface->link_type;
 
         light_block iface_block_pcapng = light_create_block(LIGHT_INTERFACE_BLOCK, (const uint32_t*)&interface_block, sizeof(struct _light_interface_description_block) + 3 * sizeof(uint32_t));
+        DCHECK_NULLP(iface_block_pcapng, return LIGHT_OUT_OF_MEMORY);
 
         if (packet_interface->timestamp_resolution) {
-                // get precision from timestamp resolution (number of 0s)
-                uint8_t timestamp_precision = get_timestamp_resolution_precision(packet_interface->timestamp_resolution);
+                // power of 10 or of 2 the resolution is written as
+                uint8_t timestamp_precision = __resolution_tsresol(packet_interface->timestamp_resolution);
                 // add precision to options
                 light_option resolution_option = light_create_option(LIGHT_OPTION_IF_TSRESOL, sizeof(timestamp_precision), (uint8_t*)&timestamp_precision);
                 light_add_option(NULL, iface_block_pcapng, resolution_option, false);
@@ -480,13 +1039,16 @@ int light_write_interface_block(light_pcapng pcapng, const light_packet_interfac
                 light_add_option(NULL, iface_block_pcapng, description_option, false);
         }
 
-        // This will increment the interfaces
-        __append_interface_block(pcapng, iface_block_pcapng, false);
-        light_write_block(pcapng->file, iface_block_pcapng);
+        // The interface only gets a handle once its block is in the file
+        int res = LIGHT_FAILURE;
+        if (light_write_block(pcapng->file, iface_block_pcapng) == iface_block_pcapng->total_length) {
+                // This will increment the interfaces
+                res = __append_interface_block(pcapng, iface_block_pcapng, false);
+        }
 
         light_free_block(iface_block_pcapng);
 
-        return LIGHT_SUCCESS;
+        return res == LIGHT_SUCCESS ? (int)pcapng->interfaces_count - 1 : res;
 }
 
 //This function encapsulates decryption secrets (like TLS Key Logs or WireGuard keys) 
@@ -540,83 +1102,294 @@ int light_write_decryption_block(light_pcapng pcapng, const light_packet_decrypt
 	return LIGHT_SUCCESS;
 }
 
-int light_write_packet(light_pcapng pcapng, const light_packet_interface* packet_interface, const light_packet_header* packet_header, const uint8_t* packet_data)
+static size_t __option_size(uint16_t length)
 {
-	DCHECK_NULLP(pcapng, return LIGHT_INVALID_ARGUMENT);
-	DCHECK_NULLP(packet_interface, return LIGHT_INVALID_ARGUMENT);
-	DCHECK_NULLP(packet_header, return LIGHT_INVALID_ARGUMENT);
-	DCHECK_NULLP(packet_data, return LIGHT_INVALID_ARGUMENT);
+	size_t padded;
+	PADD32(length, &padded);
+	return sizeof(uint32_t) + padded;
+}
 
-	if (pcapng->file == NULL) {
-		return LIGHT_INVALID_ARGUMENT;
+// Serializes one option with its padding, returns the end of what was written
+static uint8_t* __put_option(uint8_t* out, uint16_t code, uint16_t length, const void* value)
+{
+	size_t padded;
+	PADD32(length, &padded);
+	uint32_t header = code | ((uint32_t)length << 16);
+	memcpy(out, &header, sizeof(header));
+	if (length > 0) {
+		memcpy(out + sizeof(header), value, length);
+	}
+	memset(out + sizeof(header) + length, 0, padded - length);
+	return out + sizeof(header) + padded;
+}
+
+// Resolution an interface ends up with once written, 0 stands for the default microseconds
+static uint64_t __write_resolution(const light_packet_interface* packet_interface)
+{
+	uint64_t resolution = packet_interface->timestamp_resolution;
+	return resolution ? __tsresol_resolution(__resolution_tsresol(resolution)) : DEFAULT_RESOLUTION;
+}
+
+static bool __same_interface(const light_packet_interface* a, const light_packet_interface* b)
+{
+	return a->link_type == b->link_type
+		&& __write_resolution(a) == __write_resolution(b)
+		&& safe_strcmp(a->name, b->name) == 0
+		&& safe_strcmp(a->description, b->description) == 0;
+}
+
+// FNV-1a over what __same_interface compares
+static uint32_t __hash_bytes(uint32_t hash, const void* data, size_t size)
+{
+	const uint8_t* bytes = data;
+	for (size_t i = 0; i < size; i++) {
+		hash = (hash ^ bytes[i]) * 16777619u;
 	}
+	return hash;
+}
 
-	size_t iface_id = pcapng->section_interface_offset;
-	for (; iface_id < pcapng->interfaces_count; iface_id++)
-	{
-		light_packet_interface iface = pcapng->interfaces[iface_id];
-		bool match = true;
-		match = match && iface.link_type == packet_interface->link_type;
-		match = match && safe_strcmp(iface.name, packet_interface->name) == 0;
-		match = match && safe_strcmp(iface.description, packet_interface->description) == 0;
-		match = match && iface.timestamp_resolution == packet_interface->timestamp_resolution;
-		if (match) {
-			break;
+static uint32_t __interface_hash(const light_packet_interface* packet_interface)
+{
+	uint64_t resolution = __write_resolution(packet_interface);
+	uint32_t hash = 2166136261u;
+	hash = __hash_bytes(hash, &packet_interface->link_type, sizeof(packet_interface->link_type));
+	hash = __hash_bytes(hash, &resolution, sizeof(resolution));
+	// Terminators included, so NULL, "" and moved boundaries all hash apart
+	hash = packet_interface->name ? __hash_bytes(hash, packet_interface->name, strlen(packet_interface->name) + 1) : hash * 31;
+	hash = packet_interface->description ? __hash_bytes(hash, packet_interface->description, strlen(packet_interface->description) + 1) : hash * 37;
+	return hash;
+}
+
+// Slot of packet_interface in the table, either holding an equal interface or empty
+static size_t __interface_slot(light_pcapng pcapng, const light_packet_interface* packet_interface)
+{
+	size_t mask = pcapng->interface_table_size - 1;
+	size_t slot = __interface_hash(packet_interface) & mask;
+	while (pcapng->interface_table[slot] != 0
+		&& !__same_interface(&pcapng->interfaces[pcapng->interface_table[slot] - 1], packet_interface)) {
+		slot = (slot + 1) & mask;
+	}
+	return slot;
+}
+
+// Brings the table up to date with the interfaces of the current section
+static int __sync_interface_table(light_pcapng pcapng)
+{
+	if (pcapng->interface_table_start != pcapng->section_interface_offset || pcapng->interface_table_count > pcapng->interfaces_count) {
+		// New section, or interfaces were cleared
+		pcapng->interface_table_start = pcapng->section_interface_offset;
+		pcapng->interface_table_count = pcapng->section_interface_offset;
+		if (pcapng->interface_table != NULL) {
+			memset(pcapng->interface_table, 0, pcapng->interface_table_size * sizeof(uint32_t));
+		}
+	}
+
+	size_t needed = pcapng->interfaces_count - pcapng->interface_table_start;
+	if (needed * 2 >= pcapng->interface_table_size) {
+		// Kept at most half full, rebuilt from scratch at twice the size
+		size_t size = pcapng->interface_table_size ? pcapng->interface_table_size : 16;
+		while (needed * 2 >= size) {
+			size *= 2;
+		}
+		uint32_t* table = calloc(size, sizeof(uint32_t));
+		DCHECK_NULLP(table, return LIGHT_OUT_OF_MEMORY);
+		free(pcapng->interface_table);
+		pcapng->interface_table = table;
+		pcapng->interface_table_size = size;
+		pcapng->interface_table_count = pcapng->interface_table_start;
+	}
+
+	for (; pcapng->interface_table_count < pcapng->interfaces_count; pcapng->interface_table_count++) {
+		size_t slot = __interface_slot(pcapng, &pcapng->interfaces[pcapng->interface_table_count]);
+		// The first of equal interfaces wins, as with a scan
+		if (pcapng->interface_table[slot] == 0) {
+			pcapng->interface_table[slot] = (uint32_t)pcapng->interface_table_count + 1;
 		}
 	}
+	return LIGHT_SUCCESS;
+}
+
+// Handle of packet_interface in the current section, its block is written when it is new
+static int __write_interface_handle(light_pcapng pcapng, const light_packet_interface* packet_interface)
+{
+	int res = __sync_interface_table(pcapng);
+	if (res != LIGHT_SUCCESS) {
+		return res;
+	}
+	uint32_t entry = pcapng->interface_table[__interface_slot(pcapng, packet_interface)];
+	if (entry != 0) {
+		return (int)(entry - 1);
+	}
 
 	// in case interface ID of packet block to be written does not exist - was not read previously
-	if (iface_id >= pcapng->interfaces_count)
-	{
-                light_write_interface_block(pcapng, packet_interface);
+	return light_write_interface_block(pcapng, packet_interface);
+}
+
+static size_t __epb_options_size(const light_packet_header* packet_header)
+{
+	size_t options_size = 0;
+	if (packet_header->comment) {
+		options_size += __option_size((uint16_t)strlen(packet_header->comment));
+	}
+	if (packet_header->flags) {
+		options_size += __option_size(4);
+	}
+	if (packet_header->dropcount) {
+		options_size += __option_size(8);
+	}
+	if (packet_header->queue) {
+		options_size += __option_size(4);
+	}
+	if (options_size > 0) {
+		// End of options
+		options_size += __option_size(0);
 	}
+	return options_size;
+}
 
-	size_t option_size = sizeof(struct _light_enhanced_packet_block) + packet_header->captured_length;
-	PADD32(option_size, &option_size);
-	uint8_t* epb_memory = calloc(1, option_size);
+static uint32_t __epb_size(const light_packet_header* packet_header)
+{
+	size_t data_size;
+	PADD32(packet_header->captured_length, &data_size);
+	return (uint32_t)(3 * sizeof(uint32_t) + sizeof(struct _light_enhanced_packet_block) + data_size + __epb_options_size(packet_header));
+}
 
-	struct _light_enhanced_packet_block* epb = (struct _light_enhanced_packet_block*)epb_memory;
-	epb->interface_id = iface_id;
+// Lays out header, data, options and trailer of an EPB, returns the end of what was written
+static uint8_t* __put_epb(uint8_t* mem, size_t iface_id, const light_clock* clock, const light_packet_header* packet_header, const uint8_t* packet_data)
+{
+	uint32_t block_type = LIGHT_ENHANCED_PACKET_BLOCK;
+	uint32_t total_length = __epb_size(packet_header);
+	memcpy(mem, &block_type, sizeof(block_type));
+	memcpy(mem + 4, &total_length, sizeof(total_length));
 
-	struct timespec ts = packet_header->timestamp;
-	uint64_t timestamp_scale = (uint64_t)1e9 / (packet_interface->timestamp_resolution ? packet_interface->timestamp_resolution : 1000000);
-	uint64_t timestamp = (ts.tv_sec * (uint64_t)1e9 + (uint64_t)ts.tv_nsec) / timestamp_scale;
+	struct _light_enhanced_packet_block epb;
+	epb.interface_id = (uint32_t)iface_id;
 
-	epb->timestamp_high = timestamp >> 32;
-	epb->timestamp_low = timestamp & 0xFFFFFFFF;
+	uint64_t timestamp = light_clock_ticks(clock, packet_header->timestamp);
 
-	epb->capture_packet_length = packet_header->captured_length;
-	epb->original_capture_length = packet_header->original_length;
+	epb.timestamp_high = timestamp >> 32;
+	epb.timestamp_low = timestamp & 0xFFFFFFFF;
 
-	memcpy(epb->packet_data, packet_data, packet_header->captured_length);
+	epb.capture_packet_length = packet_header->captured_length;
+	epb.original_capture_length = packet_header->original_length;
 
-	light_block packet_block_pcapng = light_create_block(LIGHT_ENHANCED_PACKET_BLOCK, (const uint32_t*)epb_memory, option_size + 3 * sizeof(uint32_t));
-	free(epb_memory);
+	size_t data_size;
+	PADD32(packet_header->captured_length, &data_size);
+	uint8_t* out = mem + 8;
+	memcpy(out, &epb, sizeof(epb));
+	out += sizeof(epb);
+	memcpy(out, packet_data, packet_header->captured_length);
+	memset(out + packet_header->captured_length, 0, data_size - packet_header->captured_length);
+	out += data_size;
 
-	if (packet_header->comment)
-	{
-		light_option comment_opt = light_create_option(LIGHT_OPTION_COMMENT, strlen(packet_header->comment), packet_header->comment);
-		light_add_option(NULL, packet_block_pcapng, comment_opt, false);
+	if (packet_header->comment) {
+		out = __put_option(out, LIGHT_OPTION_COMMENT, (uint16_t)strlen(packet_header->comment), packet_header->comment);
 	}
-	if (packet_header->flags)
-	{
-		light_option flags_opt = light_create_option(LIGHT_OPTION_EPB_FLAGS, 4, &packet_header->flags);
-		light_add_option(NULL, packet_block_pcapng, flags_opt, false);
+	if (packet_header->flags) {
+		out = __put_option(out, LIGHT_OPTION_EPB_FLAGS, 4, &packet_header->flags);
 	}
-	if (packet_header->dropcount)
-	{
-		light_option dropcount_opt = light_create_option(LIGHT_OPTION_EPB_DROPCOUNT, 8, &packet_header->dropcount);
-		light_add_option(NULL, packet_block_pcapng, dropcount_opt, false);
+	if (packet_header->dropcount) {
+		out = __put_option(out, LIGHT_OPTION_EPB_DROPCOUNT, 8, &packet_header->dropcount);
 	}
-	if (packet_header->queue)
-	{
-		light_option queue_opt = light_create_option(LIGHT_OPTION_EPB_QUEUE, 4, &packet_header->queue);
-		light_add_option(NULL, packet_block_pcapng, queue_opt, false);
+	if (packet_header->queue) {
+		out = __put_option(out, LIGHT_OPTION_EPB_QUEUE, 4, &packet_header->queue);
 	}
+	if (__epb_options_size(packet_header) > 0) {
+		out = __put_option(out, LIGHT_OPTION_END_OF_OPTIONS, 0, NULL);
+	}
+	memcpy(out, &total_length, sizeof(total_length));
+	return out + sizeof(total_length);
+}
 
-	light_write_block(pcapng->file, packet_block_pcapng);
+static int __write_packet(light_pcapng pcapng, int handle, const light_packet_header* packet_header, const uint8_t* packet_data)
+{
+	// Header, data, options and trailer are laid out in the file buffer and written at once
+	uint32_t total_length = __epb_size(packet_header);
+	uint8_t* mem = light_io_reserve(pcapng->file, total_length);
+	DCHECK_NULLP(mem, return LIGHT_OUT_OF_MEMORY);
 
-	light_free_block(packet_block_pcapng);
+	__put_epb(mem, handle - pcapng->section_interface_offset, light_pcapng_clock(pcapng, (uint32_t)handle), packet_header, packet_data);
+
+	if (light_io_write(pcapng->file, mem, total_length) != total_length) {
+		return LIGHT_FAILURE;
+	}
+
+	return LIGHT_SUCCESS;
+}
+
+int light_write_packet(light_pcapng pcapng, const light_packet_interface* packet_interface, const light_packet_header* packet_header, const uint8_t* packet_data)
+{
+	DCHECK_NULLP(pcapng, return LIGHT_INVALID_ARGUMENT);
+	DCHECK_NULLP(packet_interface, return LIGHT_INVALID_ARGUMENT);
+	DCHECK_NULLP(packet_header, return LIGHT_INVALID_ARGUMENT);
+	DCHECK_NULLP(packet_data, return LIGHT_INVALID_ARGUMENT);
+
+	if (pcapng->file == NULL) {
+		return LIGHT_INVALID_ARGUMENT;
+	}
+
+	int handle = __write_interface_handle(pcapng, packet_interface);
+	if (handle < 0) {
+		return handle;
+	}
+	return __write_packet(pcapng, handle, packet_header, packet_data);
+}
+
+int light_write_packet_on(light_pcapng pcapng, int interface_handle, const light_packet_header* packet_header, const uint8_t* packet_data)
+{
+	DCHECK_NULLP(pcapng, return LIGHT_INVALID_ARGUMENT);
+	DCHECK_NULLP(packet_header, return LIGHT_INVALID_ARGUMENT);
+	DCHECK_NULLP(packet_data, return LIGHT_INVALID_ARGUMENT);
+
+	if (pcapng->file == NULL) {
+		return LIGHT_INVALID_ARGUMENT;
+	}
+	// Only interfaces of the section being written can be referred to
+	if (interface_handle < (int)pcapng->section_interface_offset || (size_t)interface_handle >= pcapng->interfaces_count) {
+		return LIGHT_INVALID_ARGUMENT;
+	}
+	return __write_packet(pcapng, interface_handle, packet_header, packet_data);
+}
+
+int light_write_packets(light_pcapng pcapng, const light_packet_interface* packet_interface, const light_packet_header* packet_headers, const uint8_t* const* packet_data, size_t count)
+{
+	DCHECK_NULLP(pcapng, return LIGHT_INVALID_ARGUMENT);
+	DCHECK_NULLP(packet_interface, return LIGHT_INVALID_ARGUMENT);
+	DCHECK_NULLP(packet_headers, return LIGHT_INVALID_ARGUMENT);
+	DCHECK_NULLP(packet_data, return LIGHT_INVALID_ARGUMENT);
+
+	if (pcapng->file == NULL) {
+		return LIGHT_INVALID_ARGUMENT;
+	}
+	if (count == 0) {
+		return LIGHT_SUCCESS;
+	}
+
+	int handle = __write_interface_handle(pcapng, packet_interface);
+	if (handle < 0) {
+		return handle;
+	}
+	size_t iface_id = handle - pcapng->section_interface_offset;
+	const light_clock* clock = light_pcapng_clock(pcapng, (uint32_t)handle);
+
+	size_t total_length = 0;
+	for (size_t i = 0; i < count; i++) {
+		DCHECK_NULLP(packet_data[i], return LIGHT_INVALID_ARGUMENT);
+		total_length += __epb_size(&packet_headers[i]);
+	}
+
+	// The whole batch goes to the backend, and its compressor, in one write
+	uint8_t* mem = light_io_reserve(pcapng->file, total_length);
+	DCHECK_NULLP(mem, return LIGHT_OUT_OF_MEMORY);
+
+	uint8_t* out = mem;
+	for (size_t i = 0; i < count; i++) {
+		out = __put_epb(out, iface_id, clock, &packet_headers[i], packet_data[i]);
+	}
+
+	if (light_io_write(pcapng->file, mem, total_length) != total_length) {
+		return LIGHT_FAILURE;
+	}
 
 	return LIGHT_SUCCESS;
 }
@@ -625,16 +1398,12 @@ int light_pcapng_close(light_pcapng pcapng)
 {
 	DCHECK_NULLP(pcapng, return 0);
 
-	light_free_block(pcapng->current);
 	light_free_file_info(pcapng->file_info);
-
-	for (size_t i = 0; i < pcapng->interfaces_count; i++)
-	{
-		light_packet_interface lif = pcapng->interfaces[i];
-		free(lif.name);
-		free(lif.description);
-	}
-	free(pcapng->interfaces);
+	free(pcapng->comment);
+	free(pcapng->batch_data);
+	free((uint32_t*)pcapng->filter.interface_ids);
+	light_index_free(pcapng->index);
+	light_pcapng_clear_interfaces(pcapng);
 
 	int res = 0;
 	if (pcapng->file != NULL)
@@ -0,0 +1,123 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef INCLUDE_LIGHT_PCAPNG_EXT_INTERNAL_H_
+#define INCLUDE_LIGHT_PCAPNG_EXT_INTERNAL_H_
+
+#include "light_pcapng_ext.h"
+#include "light_pcapng.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// How ticks of an interface turn into time, worked out once per interface
+typedef enum light_clock_kind {
+	LIGHT_CLOCK_MICRO,
+	LIGHT_CLOCK_NANO,
+	// Every tick is a whole number of nanoseconds
+	LIGHT_CLOCK_DIVISOR,
+	// 2^shift ticks per second, shift small enough for the fraction to be scaled in 64 bits
+	LIGHT_CLOCK_POW2,
+	LIGHT_CLOCK_GENERIC,
+} light_clock_kind;
+
+typedef struct light_clock {
+	uint64_t resolution;
+	light_clock_kind kind;
+	uint32_t shift;
+	uint64_t nsec_per_tick;
+} light_clock;
+
+light_clock light_make_clock(uint64_t resolution);
+struct timespec light_clock_timespec(const light_clock* clock, uint64_t ticks);
+uint64_t light_clock_ticks(const light_clock* clock, struct timespec timestamp);
+
+struct light_pcapng_t;
+
+// Parses a packet block read in the byte order of the section, see light_pcapng_set_byte_order
+typedef void (*light_parse_packet_block_fn)(struct light_pcapng_t* pcapng, const light_block_view* view, light_option_index* options,
+	uint32_t* interface_id, light_packet_header* packet_header, const uint8_t** packet_data);
+
+struct light_pcapng_t
+{
+	light_file file;
+
+	light_pcapng_file_info* file_info;
+
+	size_t interfaces_count;
+	light_packet_interface* interfaces;
+	uint32_t section_interface_offset;
+
+	// Clock of each interface, entries are checked against the interface resolution before use
+	light_clock* clocks;
+	size_t clocks_count;
+
+	// Open addressing table over the interfaces of the section being written, slots hold index + 1.
+	// Interfaces from start to count are in it, see __sync_interface_table.
+	uint32_t* interface_table;
+	size_t interface_table_size;
+	size_t interface_table_start;
+	size_t interface_table_count;
+
+	bool swap_endianness;
+	light_parse_packet_block_fn parse_packet_block;
+
+	uint32_t read_flags;
+	// Storage for borrowed comments, see LIGHT_READ_BORROWED
+	char* comment;
+	size_t comment_size;
+
+	// Storage for packet data of the last batch that could not be borrowed
+	uint8_t* batch_data;
+	size_t batch_size;
+	size_t batch_used;
+
+	uint32_t snaplen;
+
+	// Filter applied on packet headers, interface_ids is our own copy
+	bool filtered;
+	light_packet_filter filter;
+
+	// Sidecar index, see light_pcapng_load_index
+	struct light_index_t* index;
+};
+
+// Keeps track of sections and interfaces, views of other block types are ignored
+int light_pcapng_track_block(light_pcapng pcapng, const light_block_view* view);
+
+// Core of light_read_packet, reports the global interface id of the packet instead of the interface
+int light_pcapng_next_packet(light_pcapng pcapng, uint32_t* interface_id, light_packet_header* packet_header, const uint8_t** packet_data);
+
+// Sets the byte order of the section being read along with the packet parser specialized for it
+void light_pcapng_set_byte_order(light_pcapng pcapng, bool swap_endianness);
+
+// Forgets every interface seen so far, as if reading from the start of the file
+void light_pcapng_clear_interfaces(light_pcapng pcapng);
+
+// Clock of an interface, the default microsecond clock for unknown interfaces
+const light_clock* light_pcapng_clock(light_pcapng pcapng, uint32_t interface_id);
+
+// Converts a timestamp in units of the interface resolution
+struct timespec light_pcapng_timestamp(light_pcapng pcapng, uint32_t interface_id, uint64_t timestamp);
+
+void light_index_free(struct light_index_t* index);
+
+#endif /* INCLUDE_LIGHT_PCAPNG_EXT_INTERNAL_H_ */
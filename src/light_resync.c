@@ -0,0 +1,222 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "light_pcapng.h"
+#include "light_internal.h"
+#include "light_debug.h"
+
+#include <string.h>
+
+#include "endianness.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LIGHT_RESYNC_SSE2 1
+#endif
+
+static bool __is_block_type(uint32_t type)
+{
+	switch (type)
+	{
+	case LIGHT_SECTION_HEADER_BLOCK:
+	case LIGHT_INTERFACE_BLOCK:
+	case LIGHT_ENHANCED_PACKET_BLOCK:
+	case LIGHT_SIMPLE_PACKET_BLOCK:
+	case LIGHT_NAME_RESOLUTION_BLOCK:
+	case LIGHT_INTERFACE_STATISTICS_BLOCK:
+	case LIGHT_DECRYPTION_SECRETS_BLOCK:
+	case LIGHT_CUSTOM_BLOCK_1:
+	case LIGHT_CUSTOM_BLOCK_2:
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool light_check_block(const uint8_t* data, size_t size, size_t offset, bool* swap_endianness, uint32_t* type, uint32_t* length)
+{
+	if (offset > size || size - offset < 3 * sizeof(uint32_t)) {
+		return false;
+	}
+
+	uint32_t block_type, block_length, trailer;
+	memcpy(&block_type, data + offset, sizeof(block_type));
+	memcpy(&block_length, data + offset + 4, sizeof(block_length));
+
+	bool swap = *swap_endianness;
+	if (block_type == LIGHT_SECTION_HEADER_BLOCK) {
+		uint32_t magic;
+		if (size - offset < 7 * sizeof(uint32_t)) {
+			return false;
+		}
+		memcpy(&magic, data + offset + 8, sizeof(magic));
+		if (magic == BYTE_ORDER_MAGIC) {
+			swap = false;
+		}
+		else if (bswap32(magic) == BYTE_ORDER_MAGIC) {
+			swap = true;
+		}
+		else {
+			return false;
+		}
+	}
+	else if (swap) {
+		block_type = bswap32(block_type);
+	}
+	if (swap) {
+		block_length = bswap32(block_length);
+	}
+
+	if (block_length < 3 * sizeof(uint32_t) || (block_length % 4) != 0 || block_length > size - offset) {
+		return false;
+	}
+	if (block_type == LIGHT_SECTION_HEADER_BLOCK && block_length < 7 * sizeof(uint32_t)) {
+		return false;
+	}
+	memcpy(&trailer, data + offset + block_length - 4, sizeof(trailer));
+	if (swap) {
+		trailer = bswap32(trailer);
+	}
+	if (trailer != block_length) {
+		return false;
+	}
+
+	*swap_endianness = swap;
+	*type = block_type;
+	*length = block_length;
+	return true;
+}
+
+// A known block type with matching lengths, followed by another such block or the end of data
+static bool __plausible_block(const uint8_t* data, size_t size, size_t offset, bool* swap_endianness)
+{
+	uint32_t type, length, next_type, next_length;
+	if (!light_check_block(data, size, offset, swap_endianness, &type, &length) || !__is_block_type(type)) {
+		return false;
+	}
+	bool next_swap = *swap_endianness;
+	size_t next = offset + length;
+	return next == size
+		|| (light_check_block(data, size, next, &next_swap, &next_type, &next_length) && __is_block_type(next_type));
+}
+
+// Only a section header may switch the byte order, anything else has to be in the current one:
+// little endian words shifted by a few bytes often read as valid big endian blocks
+static bool __check_candidate(const uint8_t* data, size_t size, size_t offset, bool* swap_endianness)
+{
+	bool swap = *swap_endianness;
+	if (__plausible_block(data, size, offset, &swap)) {
+		*swap_endianness = swap;
+		return true;
+	}
+	return false;
+}
+
+// Cheap filter on the type and length words, in either byte order:
+// types 1 to 15 or custom blocks, a length multiple of 4, or a section header
+static bool __candidate(uint32_t type, uint32_t length)
+{
+	if (type == LIGHT_SECTION_HEADER_BLOCK) {
+		return true;
+	}
+	bool native = type != 0 && ((type & 0xFFFFFFF0) == 0 || (type & 0xBFFFFFFF) == 0x00000BAD);
+	bool swapped = type != 0 && ((type & 0xF0FFFFFF) == 0 || (type & 0xFFFFFFBF) == 0xAD0B0000);
+	return (native && (length & 0x00000003) == 0) || (swapped && (length & 0x03000000) == 0);
+}
+
+#if defined(LIGHT_RESYNC_SSE2)
+// Same as __candidate on four type words at once, one bit per lane
+static int __candidates_sse2(__m128i type, __m128i length)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i empty = _mm_cmpeq_epi32(type, zero);
+
+	__m128i native = _mm_or_si128(
+		_mm_cmpeq_epi32(_mm_and_si128(type, _mm_set1_epi32((int)0xFFFFFFF0)), zero),
+		_mm_cmpeq_epi32(_mm_and_si128(type, _mm_set1_epi32((int)0xBFFFFFFF)), _mm_set1_epi32(0x00000BAD)));
+	native = _mm_and_si128(native, _mm_cmpeq_epi32(_mm_and_si128(length, _mm_set1_epi32(0x00000003)), zero));
+
+	__m128i swapped = _mm_or_si128(
+		_mm_cmpeq_epi32(_mm_and_si128(type, _mm_set1_epi32((int)0xF0FFFFFF)), zero),
+		_mm_cmpeq_epi32(_mm_and_si128(type, _mm_set1_epi32((int)0xFFFFFFBF)), _mm_set1_epi32((int)0xAD0B0000)));
+	swapped = _mm_and_si128(swapped, _mm_cmpeq_epi32(_mm_and_si128(length, _mm_set1_epi32(0x03000000)), zero));
+
+	__m128i match = _mm_andnot_si128(empty, _mm_or_si128(native, swapped));
+	match = _mm_or_si128(match, _mm_cmpeq_epi32(type, _mm_set1_epi32(LIGHT_SECTION_HEADER_BLOCK)));
+	return _mm_movemask_ps(_mm_castsi128_ps(match));
+}
+#endif
+
+size_t light_find_block_range(const uint8_t* data, size_t size, size_t offset, size_t limit, size_t step, bool* swap_endianness)
+{
+	if (limit > size) {
+		limit = size;
+	}
+	if (step == 4) {
+		offset = (offset + 3) & ~(size_t)3;
+	}
+
+#if defined(LIGHT_RESYNC_SSE2)
+	// Sixteen bytes of candidate offsets per round, the lengths sit one word after the types
+	while (offset + 16 + 3 + 4 <= size && offset + 16 <= limit) {
+		uint32_t mask = 0;
+		for (size_t k = 0; k < 4; k += step) {
+			__m128i type = _mm_loadu_si128((const __m128i*)(data + offset + k));
+			__m128i length = _mm_loadu_si128((const __m128i*)(data + offset + k + 4));
+			int lanes = __candidates_sse2(type, length);
+			for (int lane = 0; lane < 4; lane++) {
+				if (lanes & (1 << lane)) {
+					mask |= 1u << (lane * 4 + k);
+				}
+			}
+		}
+		while (mask != 0) {
+			size_t bit = 0;
+			while (!(mask & (1u << bit))) {
+				bit++;
+			}
+			mask &= mask - 1;
+			if (__check_candidate(data, size, offset + bit, swap_endianness)) {
+				return offset + bit;
+			}
+		}
+		offset += 16;
+	}
+#endif
+
+	for (; offset < limit && offset + 8 <= size; offset += step) {
+		uint32_t type, length;
+		memcpy(&type, data + offset, sizeof(type));
+		memcpy(&length, data + offset + 4, sizeof(length));
+		if (__candidate(type, length) && __check_candidate(data, size, offset, swap_endianness)) {
+			return offset;
+		}
+	}
+
+	return size;
+}
+
+size_t light_find_block(const uint8_t* data, size_t size, size_t offset, bool* swap_endianness)
+{
+	DCHECK_NULLP(data, return size);
+	DCHECK_NULLP(swap_endianness, return size);
+	return light_find_block_range(data, size, offset, size, 1, swap_endianness);
+}
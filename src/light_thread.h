@@ -0,0 +1,148 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef INCLUDE_LIGHT_THREAD_H_
+#define INCLUDE_LIGHT_THREAD_H_
+
+// Minimal threading layer over pthreads and the Windows API, only what the library needs
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+
+typedef HANDLE light_thread;
+typedef SRWLOCK light_mutex;
+typedef CONDITION_VARIABLE light_cond;
+
+typedef struct light_thread_start {
+	void (*fn)(void* arg);
+	void* arg;
+} light_thread_start;
+
+static inline DWORD WINAPI __light_thread_main(LPVOID param)
+{
+	light_thread_start start = *(light_thread_start*)param;
+	free(param);
+	start.fn(start.arg);
+	return 0;
+}
+
+static inline int light_thread_create(light_thread* thread, void (*fn)(void* arg), void* arg)
+{
+	light_thread_start* start = malloc(sizeof(light_thread_start));
+	if (start == NULL) {
+		return -1;
+	}
+	start->fn = fn;
+	start->arg = arg;
+	*thread = CreateThread(NULL, 0, __light_thread_main, start, 0, NULL);
+	if (*thread == NULL) {
+		free(start);
+		return -1;
+	}
+	return 0;
+}
+
+static inline void light_thread_join(light_thread thread)
+{
+	WaitForSingleObject(thread, INFINITE);
+	CloseHandle(thread);
+}
+
+static inline void light_mutex_init(light_mutex* mutex) { InitializeSRWLock(mutex); }
+static inline void light_mutex_destroy(light_mutex* mutex) { (void)mutex; }
+static inline void light_mutex_lock(light_mutex* mutex) { AcquireSRWLockExclusive(mutex); }
+static inline void light_mutex_unlock(light_mutex* mutex) { ReleaseSRWLockExclusive(mutex); }
+
+static inline void light_cond_init(light_cond* cond) { InitializeConditionVariable(cond); }
+static inline void light_cond_destroy(light_cond* cond) { (void)cond; }
+static inline void light_cond_wait(light_cond* cond, light_mutex* mutex) { SleepConditionVariableSRW(cond, mutex, INFINITE, 0); }
+static inline void light_cond_broadcast(light_cond* cond) { WakeAllConditionVariable(cond); }
+
+static inline uint32_t light_cpu_count(void)
+{
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors > 0 ? (uint32_t)info.dwNumberOfProcessors : 1;
+}
+
+#else
+#include <pthread.h>
+#include <unistd.h>
+
+typedef pthread_t light_thread;
+typedef pthread_mutex_t light_mutex;
+typedef pthread_cond_t light_cond;
+
+typedef struct light_thread_start {
+	void (*fn)(void* arg);
+	void* arg;
+} light_thread_start;
+
+static inline void* __light_thread_main(void* param)
+{
+	light_thread_start start = *(light_thread_start*)param;
+	free(param);
+	start.fn(start.arg);
+	return NULL;
+}
+
+static inline int light_thread_create(light_thread* thread, void (*fn)(void* arg), void* arg)
+{
+	light_thread_start* start = malloc(sizeof(light_thread_start));
+	if (start == NULL) {
+		return -1;
+	}
+	start->fn = fn;
+	start->arg = arg;
+	if (pthread_create(thread, NULL, __light_thread_main, start) != 0) {
+		free(start);
+		return -1;
+	}
+	return 0;
+}
+
+static inline void light_thread_join(light_thread thread)
+{
+	pthread_join(thread, NULL);
+}
+
+static inline void light_mutex_init(light_mutex* mutex) { pthread_mutex_init(mutex, NULL); }
+static inline void light_mutex_destroy(light_mutex* mutex) { pthread_mutex_destroy(mutex); }
+static inline void light_mutex_lock(light_mutex* mutex) { pthread_mutex_lock(mutex); }
+static inline void light_mutex_unlock(light_mutex* mutex) { pthread_mutex_unlock(mutex); }
+
+static inline void light_cond_init(light_cond* cond) { pthread_cond_init(cond, NULL); }
+static inline void light_cond_destroy(light_cond* cond) { pthread_cond_destroy(cond); }
+static inline void light_cond_wait(light_cond* cond, light_mutex* mutex) { pthread_cond_wait(cond, mutex); }
+static inline void light_cond_broadcast(light_cond* cond) { pthread_cond_broadcast(cond); }
+
+static inline uint32_t light_cpu_count(void)
+{
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (uint32_t)count : 1;
+}
+
+#endif
+
+#endif /* INCLUDE_LIGHT_THREAD_H_ */
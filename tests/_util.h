@@ -3,6 +3,10 @@
 
 #include "light_io.h"
 #include "light_pcapng.h"
+#include "light_pcapng_ext.h"
+
+#include <stdlib.h>
+#include <string.h>
 
 int light_file_diff(light_file a, light_file b, FILE* out) {
 
@@ -38,4 +42,155 @@ int light_file_diff(light_file a, light_file b, FILE* out) {
 	}
 
 	return 0;
-}
\ No newline at end of file
+}
+
+// strcmp that also takes NULL, which only equals NULL
+static int safe_strcmp(const char* a, const char* b)
+{
+	if (!a || !b) {
+		return a != b;
+	}
+	return strcmp(a, b);
+}
+
+// Reads the packets of both files, which it closes, with the same snaplen and read flags
+int light_packets_diff(light_file a, light_file b, uint32_t snaplen, uint32_t flags, FILE* out) {
+
+	light_pcapng pcapng_a = light_pcapng_create(a, "rb", NULL);
+	light_pcapng pcapng_b = light_pcapng_create(b, "rb", NULL);
+	if (pcapng_a == NULL || pcapng_b == NULL) {
+		fprintf(out, "Unable to read packets\n");
+		light_pcapng_close(pcapng_a);
+		light_pcapng_close(pcapng_b);
+		return 1;
+	}
+	light_pcapng_set_snaplen(pcapng_a, snaplen);
+	light_pcapng_set_snaplen(pcapng_b, snaplen);
+	light_pcapng_set_read_flags(pcapng_a, flags);
+	light_pcapng_set_read_flags(pcapng_b, flags);
+
+	int res = 0;
+	for (int p = 1; res == 0; p++)
+	{
+		light_packet_interface iface_a = { 0 };
+		light_packet_interface iface_b = { 0 };
+		light_packet_header header_a = { 0 };
+		light_packet_header header_b = { 0 };
+		const uint8_t* data_a = NULL;
+		const uint8_t* data_b = NULL;
+		int read_a = light_read_packet(pcapng_a, &iface_a, &header_a, &data_a);
+		int read_b = light_read_packet(pcapng_b, &iface_b, &header_b, &data_b);
+
+		if (read_a != read_b || !data_a != !data_b) {
+			fprintf(out, "packet #%d: only in one file\n", p);
+			res = 1;
+		}
+		else if (data_a == NULL) {
+			// EOF
+			break;
+		}
+		else if (header_a.captured_length != header_b.captured_length
+			|| header_a.original_length != header_b.original_length
+			|| header_a.timestamp.tv_sec != header_b.timestamp.tv_sec
+			|| header_a.timestamp.tv_nsec != header_b.timestamp.tv_nsec
+			|| iface_a.link_type != iface_b.link_type
+			|| memcmp(data_a, data_b, header_a.captured_length) != 0) {
+			fprintf(out, "packet #%d: different\n", p);
+			res = 1;
+		}
+		if (!(flags & LIGHT_READ_BORROWED)) {
+			free(header_a.comment);
+			free(header_b.comment);
+		}
+	}
+
+	light_pcapng_close(pcapng_a);
+	light_pcapng_close(pcapng_b);
+	return res;
+}
+
+// Compressible, but not down to nothing, and different for every packet p
+void fill_packet(uint8_t* data, uint32_t length, int p) {
+
+	uint32_t state = 2166136261u ^ (uint32_t)p;
+	for (uint32_t i = 0; i < length; i++) {
+		state = state * 1664525u + 1013904223u;
+		data[i] = (uint8_t)((state >> 24) & 0x1F);
+	}
+}
+
+static uint32_t max_length(const uint32_t* lengths, size_t length_count) {
+
+	uint32_t max = 0;
+	for (size_t i = 0; i < length_count; i++) {
+		max = lengths[i] > max ? lengths[i] : max;
+	}
+	return max;
+}
+
+// Writes packets first to first + count - 1 with fill_packet, packet p is lengths[p % length_count] long
+// and stamped with second p
+int write_capture(const char* path, const char* mode, int first, int count, const uint32_t* lengths, size_t length_count) {
+
+	light_pcapng writer = light_pcapng_open(path, mode);
+	uint8_t* data = malloc(max_length(lengths, length_count));
+	if (writer == NULL || data == NULL) {
+		fprintf(stderr, "Unable to write %s as %s\n", path, mode);
+		light_pcapng_close(writer);
+		free(data);
+		return 1;
+	}
+	light_packet_interface iface = { 0 };
+	iface.link_type = 1;
+	int res = 0;
+	for (int p = first; p < first + count && res == 0; p++) {
+		light_packet_header header = { 0 };
+		header.captured_length = lengths[p % length_count];
+		header.original_length = header.captured_length;
+		header.timestamp.tv_sec = p;
+		fill_packet(data, header.captured_length, p);
+		if (light_write_packet(writer, &iface, &header, data) != LIGHT_SUCCESS) {
+			fprintf(stderr, "Packet #%d not written\n", p + 1);
+			res = 1;
+		}
+	}
+	light_pcapng_close(writer);
+	free(data);
+	return res;
+}
+
+// Reads back what write_capture wrote, count packets from the first one
+int check_capture(const char* path, const char* mode, int count, const uint32_t* lengths, size_t length_count) {
+
+	light_pcapng reader = light_pcapng_open(path, mode);
+	uint8_t* expected = malloc(max_length(lengths, length_count));
+	if (reader == NULL || expected == NULL) {
+		fprintf(stderr, "Unable to read %s as %s\n", path, mode);
+		light_pcapng_close(reader);
+		free(expected);
+		return 1;
+	}
+	int res = 0;
+	int p = 0;
+	light_packet_interface iface = { 0 };
+	light_packet_header header = { 0 };
+	const uint8_t* data = NULL;
+	while (res == 0 && light_read_packet(reader, &iface, &header, &data) == LIGHT_SUCCESS && data != NULL) {
+		uint32_t length = lengths[p % length_count];
+		fill_packet(expected, length, p);
+		if (header.captured_length != length || header.timestamp.tv_sec != p
+			|| memcmp(data, expected, length) != 0) {
+			fprintf(stderr, "Packet #%d differs\n", p + 1);
+			res = 1;
+		}
+		free(header.comment);
+		p++;
+	}
+	light_pcapng_close(reader);
+	free(expected);
+	if (res == 0 && p != count) {
+		fprintf(stderr, "%d packets read back instead of %d\n", p, count);
+		res = 1;
+	}
+	return res;
+}
@@ -0,0 +1,205 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Builds a sidecar index for a capture and checks that seeking by timestamp
+// lands on the right packet with the right interface state.
+
+#include "light_pcapng_ext.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "_util.h"
+
+typedef struct packet_summary {
+	struct timespec timestamp;
+	uint32_t captured_length;
+	uint16_t link_type;
+	char* interface_name;
+} packet_summary;
+
+static int compare_ts(const struct timespec* a, const struct timespec* b)
+{
+	if (a->tv_sec != b->tv_sec) {
+		return a->tv_sec < b->tv_sec ? -1 : 1;
+	}
+	if (a->tv_nsec != b->tv_nsec) {
+		return a->tv_nsec < b->tv_nsec ? -1 : 1;
+	}
+	return 0;
+}
+
+// Copies infile without its last cut bytes, or with extra garbage bytes at the end
+static int copy_damaged(const char* infile, const char* outfile, long cut, long extra)
+{
+	FILE* in = fopen(infile, "rb");
+	FILE* out = fopen(outfile, "wb");
+	if (in == NULL || out == NULL || fseek(in, 0, SEEK_END) != 0) {
+		return 1;
+	}
+	long size = ftell(in) - cut;
+	rewind(in);
+	for (long i = 0; i < size; i++) {
+		fputc(fgetc(in), out);
+	}
+	for (long i = 0; i < extra; i++) {
+		fputc(0x5A, out);
+	}
+	fclose(in);
+	fclose(out);
+	return 0;
+}
+
+// Seeks to the timestamp of packet target and reads everything up to the end
+static int check_seek(light_pcapng pcapng, const packet_summary* packets, size_t count, size_t target)
+{
+	if (light_pcapng_seek_time(pcapng, packets[target].timestamp) != 0) {
+		fprintf(stderr, "Seek to packet #%zu failed\n", target + 1);
+		return 1;
+	}
+
+	// Lands on the first packet with that timestamp
+	size_t expected = target;
+	while (expected > 0 && compare_ts(&packets[expected - 1].timestamp, &packets[target].timestamp) == 0) {
+		expected--;
+	}
+
+	for (size_t i = expected; i < count; i++) {
+		light_packet_interface pkt_interface = { 0 };
+		light_packet_header pkt_header = { 0 };
+		const uint8_t* pkt_data = NULL;
+		if (light_read_packet(pcapng, &pkt_interface, &pkt_header, &pkt_data) != 0) {
+			fprintf(stderr, "Seek to packet #%zu: packet #%zu missing\n", target + 1, i + 1);
+			return 1;
+		}
+		free(pkt_header.comment);
+		if (compare_ts(&pkt_header.timestamp, &packets[i].timestamp) != 0 ||
+			pkt_header.captured_length != packets[i].captured_length ||
+			pkt_interface.link_type != packets[i].link_type ||
+			safe_strcmp(pkt_interface.name, packets[i].interface_name) != 0) {
+			fprintf(stderr, "Seek to packet #%zu: packet #%zu mismatch\n", target + 1, i + 1);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+int main(int argc, const char** args)
+{
+	if (argc != 3) {
+		fprintf(stderr, "Usage %s [infile] [index]", args[0]);
+		return 1;
+	}
+
+	const char* infile = args[1];
+	const char* index = args[2];
+
+	if (light_pcapng_build_index(infile, index) != 0) {
+		fprintf(stderr, "Unable to index: %s\n", infile);
+		return 1;
+	}
+
+	light_pcapng reference = light_pcapng_open(infile, "rb");
+	if (reference == NULL) {
+		fprintf(stderr, "Unable to read: %s\n", infile);
+		return 1;
+	}
+
+	packet_summary* packets = NULL;
+	size_t count = 0;
+	bool sorted = true;
+	while (1) {
+		light_packet_interface pkt_interface = { 0 };
+		light_packet_header pkt_header = { 0 };
+		const uint8_t* pkt_data = NULL;
+		if (light_read_packet(reference, &pkt_interface, &pkt_header, &pkt_data) != 0) {
+			break;
+		}
+		free(pkt_header.comment);
+		packets = realloc(packets, (count + 1) * sizeof(packet_summary));
+		packets[count].timestamp = pkt_header.timestamp;
+		packets[count].captured_length = pkt_header.captured_length;
+		packets[count].link_type = pkt_interface.link_type;
+		packets[count].interface_name = pkt_interface.name ? strdup(pkt_interface.name) : NULL;
+		if (count > 0 && compare_ts(&packets[count - 1].timestamp, &pkt_header.timestamp) > 0) {
+			sorted = false;
+		}
+		count++;
+	}
+	light_pcapng_close(reference);
+
+	light_pcapng pcapng = light_pcapng_open(infile, "rb");
+	int res = light_pcapng_load_index(pcapng, index) != 0;
+	if (res != 0) {
+		fprintf(stderr, "Unable to load index: %s\n", index);
+	}
+
+	if (res == 0 && count > 0 && sorted) {
+		// Backwards on purpose, every seek has to restore the interfaces
+		res = check_seek(pcapng, packets, count, count - 1)
+			|| check_seek(pcapng, packets, count, count / 2)
+			|| check_seek(pcapng, packets, count, 0)
+			|| check_seek(pcapng, packets, count, count / 3);
+
+		// Nothing after the last packet
+		struct timespec late = packets[count - 1].timestamp;
+		late.tv_sec += 1;
+		if (res == 0 && light_pcapng_seek_time(pcapng, late) == 0) {
+			fprintf(stderr, "Seek past the last packet succeeded\n");
+			res = 1;
+		}
+	}
+
+	size_t length = strlen(index);
+	char* damaged = malloc(length + sizeof(".damaged.pcapng"));
+	memcpy(damaged, index, length);
+	memcpy(damaged + length, ".damaged.pcapng", sizeof(".damaged.pcapng"));
+
+	// The index no longer matches a capture that grew since
+	if (res == 0 && copy_damaged(infile, damaged, 0, 32) == 0) {
+		light_pcapng grown = light_pcapng_open(damaged, "rb");
+		if (grown == NULL || light_pcapng_load_index(grown, index) == 0) {
+			fprintf(stderr, "Loaded the index of a capture that changed since\n");
+			res = 1;
+		}
+		light_pcapng_close(grown);
+	}
+
+	// A truncated last block or a partial header is an error, not the end of the capture
+	if (res == 0 && (copy_damaged(infile, damaged, 6, 0) != 0 || light_pcapng_build_index(damaged, index) == 0)) {
+		fprintf(stderr, "Indexed a truncated capture\n");
+		res = 1;
+	}
+	if (res == 0 && (copy_damaged(infile, damaged, 0, 5) != 0 || light_pcapng_build_index(damaged, index) == 0)) {
+		fprintf(stderr, "Indexed a capture with a partial block header\n");
+		res = 1;
+	}
+	remove(damaged);
+	free(damaged);
+
+	for (size_t i = 0; i < count; i++) {
+		free(packets[i].interface_name);
+	}
+	free(packets);
+	light_pcapng_close(pcapng);
+
+	return res;
+}
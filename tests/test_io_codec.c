@@ -0,0 +1,78 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Writes a compressed capture with packets from a few bytes up to 64KB, then checks that
+// reading it back, with reads both staged and straight into the destination, gives them back.
+
+#include "light_pcapng_ext.h"
+#include "light_pcapng.h"
+#include "light_io.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "_util.h"
+
+#define PACKET_COUNT 200
+#define MAX_PACKET_SIZE 65000
+
+static const uint32_t sizes[] = { 60, 1500, 9000, MAX_PACKET_SIZE, 3, 4096, 20000, 300 };
+
+int main(int argc, const char** args)
+{
+	if (argc != 2) {
+		fprintf(stderr, "Usage %s [outfile]", args[0]);
+		return 1;
+	}
+	const char* path = args[1];
+
+	size_t size_count = sizeof(sizes) / sizeof(sizes[0]);
+	if (write_capture(path, "wb", 0, PACKET_COUNT, sizes, size_count) != 0
+		|| check_capture(path, "rb", PACKET_COUNT, sizes, size_count) != 0) {
+		return 1;
+	}
+
+	// Backends that seek give the same bytes again after seeking back
+	light_file file = light_io_open(path, "rb");
+	uint8_t* first = malloc(MAX_PACKET_SIZE);
+	uint8_t* again = malloc(MAX_PACKET_SIZE);
+	if (file == NULL || first == NULL || again == NULL) {
+		fprintf(stderr, "Unable to open: %s\n", path);
+		return 1;
+	}
+	int res = 0;
+	if (light_io_read(file, first, 100) != 100 || light_io_read(file, first + 100, MAX_PACKET_SIZE - 100) != MAX_PACKET_SIZE - 100) {
+		fprintf(stderr, "Short read: %s\n", path);
+		res = 1;
+	}
+	else if (light_io_seek(file, 10, SEEK_SET) == 10) {
+		if (light_io_tell(file) != 10 || light_io_read(file, again, MAX_PACKET_SIZE - 10) != MAX_PACKET_SIZE - 10
+			|| memcmp(first + 10, again, MAX_PACKET_SIZE - 10) != 0) {
+			fprintf(stderr, "Different bytes after seeking back: %s\n", path);
+			res = 1;
+		}
+	}
+	light_io_close(file);
+
+	free(first);
+	free(again);
+	return res;
+}
@@ -0,0 +1,132 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Copies a capture with the O_DIRECT writer, half of it appended after reopening
+
+#include "light_io_direct.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "_util.h"
+
+static int64_t file_size(const char* filename)
+{
+	light_file file = light_io_open(filename, "rb");
+	int64_t size = file != NULL && light_io_seek(file, 0, SEEK_END) >= 0 ? light_io_tell(file) : -1;
+	light_io_close(file);
+	return size;
+}
+
+static int copy_range(light_file in, const char* outfile, const char* mode, size_t count)
+{
+	light_file out = light_io_direct_open(outfile, mode);
+	if (out == NULL) {
+		return 1;
+	}
+	int64_t start = light_io_tell(out);
+	// Odd sized writes, so blocks are left partial in between
+	uint8_t buffer[3001];
+	size_t done = 0;
+	int res = 0;
+	while (done < count) {
+		size_t wanted = count - done < sizeof(buffer) ? count - done : sizeof(buffer);
+		size_t read = light_io_read(in, buffer, wanted);
+		if (read == 0) {
+			break;
+		}
+		if (light_io_write(out, buffer, read) != read) {
+			res = 1;
+			break;
+		}
+		done += read;
+		// A flush in the middle of a block has to leave it complete on disk
+		if (done == 3 * sizeof(buffer)) {
+			res |= light_io_flush(out);
+			// Preallocated extents stay out of sight of readers, only the last block is padded
+			int64_t size = file_size(outfile);
+			if (size < start + (int64_t)done || size > start + (int64_t)done + 4096) {
+				fprintf(stderr, "Size %lld after a flush at %lld\n", (long long)size, (long long)(start + done));
+				res = 1;
+			}
+		}
+	}
+	res |= light_io_close(out);
+	return res;
+}
+
+// A write the device refuses is short, not only reported at close
+static int check_full(void)
+{
+	light_file out = light_io_direct_open("/dev/full", "wb");
+	if (out == NULL) {
+		return 0;
+	}
+	// Exactly one buffer of the backend, written out at the end of the call
+	size_t count = 4 * 1024 * 1024;
+	uint8_t* buffer = calloc(1, count);
+	int res = buffer == NULL || light_io_write(out, buffer, count) == count;
+	if (res != 0) {
+		fprintf(stderr, "Write to a full device succeeded\n");
+	}
+	light_io_close(out);
+	free(buffer);
+	return res;
+}
+
+int main(int argc, const char** args) {
+
+	if (argc != 3) {
+		fprintf(stderr, "Usage %s [infile] [outfile]", args[0]);
+		return 1;
+	}
+
+	const char* infile = args[1];
+	const char* outfile = args[2];
+	light_file probe = light_io_direct_open(outfile, "wb");
+	if (probe == NULL) {
+		fprintf(stderr, "Direct I/O not available, skipped\n");
+		return 0;
+	}
+	light_io_close(probe);
+
+	light_file in = light_io_open(infile, "rb");
+	int res = copy_range(in, outfile, "wb", 10000);
+	res |= copy_range(in, outfile, "ab", SIZE_MAX);
+	light_io_close(in);
+	if (res != 0) {
+		fprintf(stderr, "Unable to copy %s to %s\n", infile, outfile);
+		return 1;
+	}
+
+	light_file copy = light_io_open(outfile, "rb");
+	light_file file = light_io_open(infile, "rb");
+	res = light_file_diff(copy, file, stderr);
+	// Trailing padding or preallocated space would show up as an extra, broken block
+	if (res == 0 && (light_io_seek(copy, 0, SEEK_END) < 0 || light_io_seek(file, 0, SEEK_END) < 0
+		|| light_io_tell(copy) != light_io_tell(file))) {
+		fprintf(stderr, "Size mismatch: %s\n", outfile);
+		res = 1;
+	}
+	light_io_close(copy);
+	light_io_close(file);
+
+	return res || check_full();
+}
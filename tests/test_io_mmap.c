@@ -0,0 +1,60 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "light_io_mmap.h"
+
+#include <stdio.h>
+
+#include "_util.h"
+
+int main(int argc, const char** args) {
+
+	if (argc != 2) {
+		fprintf(stderr, "Usage %s [infile]", args[0]);
+		return 1;
+	}
+
+	const char* infile = args[1];
+	light_file map = light_io_mmap_open(infile);
+	if (map == NULL) {
+		fprintf(stderr, "Unable to map pcapng: %s\n", infile);
+		return 1;
+	}
+	light_file file = light_io_open(infile, "rb");
+
+	int res = light_file_diff(map, file, stderr);
+
+	light_io_close(map);
+	light_io_close(file);
+
+	// Packets parsed in place out of the mapping, copied out or borrowed, and with snaplen seeks
+	if (res == 0) {
+		res = light_packets_diff(light_io_mmap_open(infile), light_io_open(infile, "rb"), LIGHT_SNAPLEN_UNLIMITED, 0, stderr);
+	}
+	if (res == 0) {
+		res = light_packets_diff(light_io_mmap_open(infile), light_io_open(infile, "rb"), LIGHT_SNAPLEN_UNLIMITED, LIGHT_READ_BORROWED, stderr);
+	}
+	if (res == 0) {
+		res = light_packets_diff(light_io_mmap_open(infile), light_io_open(infile, "rb"), 16, LIGHT_READ_BORROWED, stderr);
+	}
+
+	return res;
+}
@@ -0,0 +1,65 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "light_io_file.h"
+
+#include <stdio.h>
+
+#include "_util.h"
+
+int main(int argc, const char** args) {
+
+	if (argc != 2) {
+		fprintf(stderr, "Usage %s [infile]", args[0]);
+		return 1;
+	}
+
+	const char* infile = args[1];
+	// Small buffers, so blocks straddle them and the ring wraps around
+	light_file readahead = light_io_file_open_readahead(infile, 1000, 2);
+	if (readahead == NULL) {
+		fprintf(stderr, "Unable to open pcapng: %s\n", infile);
+		return 1;
+	}
+	light_file file = light_io_open(infile, "rb");
+
+	int res = light_file_diff(readahead, file, stderr);
+
+	// Reading again after a seek drops what was read ahead
+	if (res == 0) {
+		if (light_io_seek(readahead, 0, SEEK_SET) < 0 || light_io_seek(file, 0, SEEK_SET) < 0) {
+			fprintf(stderr, "Unable to seek back: %s\n", infile);
+			res = 1;
+		}
+		else {
+			res = light_file_diff(readahead, file, stderr);
+		}
+	}
+
+	light_io_close(readahead);
+	light_io_close(file);
+
+	// Snaplen reads seek over the rest of every packet, forwards within the ring or past it
+	if (res == 0) {
+		res = light_packets_diff(light_io_file_open_readahead(infile, 1000, 2), light_io_open(infile, "rb"), 16, 0, stderr);
+	}
+
+	return res;
+}
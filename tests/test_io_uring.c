@@ -0,0 +1,104 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Reads a capture through light_io_uring_open and copies it with an io_uring writer
+
+#include "light_io_uring.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "_util.h"
+
+static int copy_file(const char* infile, const char* outfile)
+{
+	light_file in = light_io_open(infile, "rb");
+	light_file out = light_io_uring_open(outfile, "wb");
+	if (in == NULL || out == NULL) {
+		light_io_close(in);
+		light_io_close(out);
+		return 1;
+	}
+	// Odd sized writes, so they straddle the writer buffers
+	uint8_t buffer[3001];
+	size_t read;
+	int res = 0;
+	while ((read = light_io_read(in, buffer, sizeof(buffer))) > 0) {
+		if (light_io_write(out, buffer, read) != read) {
+			res = 1;
+			break;
+		}
+	}
+	light_io_close(in);
+	res |= light_io_close(out);
+	return res;
+}
+
+int main(int argc, const char** args) {
+
+	if (argc != 3) {
+		fprintf(stderr, "Usage %s [infile] [outfile]", args[0]);
+		return 1;
+	}
+
+	const char* infile = args[1];
+	const char* outfile = args[2];
+	light_file uring = light_io_uring_open(infile, "rb");
+	if (uring == NULL) {
+		// Not Linux, or the kernel does not let us use io_uring
+		fprintf(stderr, "io_uring not available, skipped\n");
+		return 0;
+	}
+	light_file file = light_io_open(infile, "rb");
+
+	int res = light_file_diff(uring, file, stderr);
+
+	if (res == 0) {
+		if (light_io_seek(uring, 0, SEEK_SET) < 0 || light_io_seek(file, 0, SEEK_SET) < 0) {
+			fprintf(stderr, "Unable to seek back: %s\n", infile);
+			res = 1;
+		}
+		else {
+			res = light_file_diff(uring, file, stderr);
+		}
+	}
+	light_io_close(uring);
+	light_io_close(file);
+
+	// Snaplen reads seek over the rest of every packet, within the submitted reads
+	if (res == 0) {
+		res = light_packets_diff(light_io_uring_open(infile, "rb"), light_io_open(infile, "rb"), 16, 0, stderr);
+	}
+
+	if (res == 0 && copy_file(infile, outfile) != 0) {
+		fprintf(stderr, "Unable to copy %s to %s\n", infile, outfile);
+		res = 1;
+	}
+	if (res == 0) {
+		light_file copy = light_io_open(outfile, "rb");
+		file = light_io_open(infile, "rb");
+		res = light_file_diff(copy, file, stderr);
+		light_io_close(copy);
+		light_io_close(file);
+	}
+
+	return res;
+}
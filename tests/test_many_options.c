@@ -0,0 +1,136 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// Builds a capture whose packet carries far more options than a recursive
+// parser can handle on the stack, then reads it back through both APIs.
+
+#include "light_pcapng.h"
+#include "light_pcapng_ext.h"
+#include "light_io_mem.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_OPTIONS 200000
+#define CUSTOM_OPTION_CODE 0x1234
+
+static uint32_t* append_block_header(uint32_t* iter, uint32_t type, uint32_t total_length)
+{
+	*iter++ = type;
+	*iter++ = total_length;
+	return iter;
+}
+
+static uint32_t* append_option(uint32_t* iter, uint16_t code, uint16_t length, const void* data)
+{
+	*iter++ = code | ((uint32_t)length << 16);
+	memcpy(iter, data, length);
+	return iter + (length + 3) / 4;
+}
+
+int main(int argc, const char** args)
+{
+	const char comment[] = "last option";
+	const uint32_t flags = 0x1;
+	const uint32_t custom = 0xCAFE;
+
+	// SHB (28) + IDB (20) + EPB header (32) + options
+	size_t size = 28 + 20 + 32 + NUM_OPTIONS * 8 + 16 + 8 + 4;
+	uint32_t* memory = calloc(1, size);
+	uint32_t* iter = memory;
+
+	iter = append_block_header(iter, LIGHT_SECTION_HEADER_BLOCK, 28);
+	*iter++ = BYTE_ORDER_MAGIC;
+	*iter++ = 1;
+	*iter++ = 0xFFFFFFFF;
+	*iter++ = 0xFFFFFFFF;
+	*iter++ = 28;
+
+	iter = append_block_header(iter, LIGHT_INTERFACE_BLOCK, 20);
+	*iter++ = 1;
+	*iter++ = 0;
+	*iter++ = 20;
+
+	uint32_t epb_length = (uint32_t)(size - 48);
+	iter = append_block_header(iter, LIGHT_ENHANCED_PACKET_BLOCK, epb_length);
+	*iter++ = 0; // interface
+	*iter++ = 0;
+	*iter++ = 1;
+	*iter++ = 0; // no data
+	*iter++ = 0;
+	for (int i = 0; i < NUM_OPTIONS; i++) {
+		iter = append_option(iter, CUSTOM_OPTION_CODE, sizeof(custom), &custom);
+	}
+	iter = append_option(iter, LIGHT_OPTION_COMMENT, sizeof(comment) - 1, comment);
+	iter = append_option(iter, LIGHT_OPTION_EPB_FLAGS, sizeof(flags), &flags);
+	iter = append_option(iter, 0, 0, NULL);
+	*iter++ = epb_length;
+
+	if ((uint8_t*)iter - (uint8_t*)memory != size) {
+		fprintf(stderr, "Capture layout is broken\n");
+		return 1;
+	}
+
+	// Linked list API
+	light_file file = light_io_mem_create(memory, size);
+	light_block block = NULL;
+	bool swap_endianness = false;
+	int blocks = 0;
+	int options = 0;
+	light_read_block(file, &block, &swap_endianness);
+	while (block != NULL) {
+		blocks++;
+		if (block->type == LIGHT_ENHANCED_PACKET_BLOCK) {
+			for (light_option opt = block->options; opt != NULL; opt = opt->next_option) {
+				options++;
+			}
+		}
+		light_read_block(file, &block, &swap_endianness);
+	}
+	light_io_close(file);
+
+	// endofopt is part of the list
+	if (blocks != 3 || options != NUM_OPTIONS + 3) {
+		fprintf(stderr, "Read %d blocks and %d options\n", blocks, options);
+		return 1;
+	}
+
+	// Indexed lookups
+	light_pcapng reader = light_pcapng_create(light_io_mem_create(memory, size), "rb", NULL);
+	light_packet_interface pkt_interface = { 0 };
+	light_packet_header pkt_header = { 0 };
+	const uint8_t* pkt_data = NULL;
+	int res = light_read_packet(reader, &pkt_interface, &pkt_header, &pkt_data);
+	if (res != 0 || pkt_data == NULL) {
+		fprintf(stderr, "Unable to read the packet\n");
+		return 1;
+	}
+	if (pkt_header.flags != flags || pkt_header.comment == NULL || strcmp(pkt_header.comment, comment) != 0) {
+		fprintf(stderr, "Options do not match\n");
+		return 1;
+	}
+	free(pkt_header.comment);
+	light_pcapng_close(reader);
+
+	free(memory);
+	return 0;
+}
@@ -0,0 +1,111 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// Reads a capture with light_read_packets and light_read_packet side by side
+// and checks that both APIs report the same packets.
+
+#include "light_pcapng_ext.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "_util.h"
+
+// Small on purpose, so the capture spans many batches
+#define BATCH_SIZE 7
+
+int main(int argc, const char** args)
+{
+	if (argc != 2) {
+		fprintf(stderr, "Usage %s [infile]", args[0]);
+		return 1;
+	}
+
+	light_pcapng single = light_pcapng_open(args[1], "rb");
+	light_pcapng batched = light_pcapng_open(args[1], "rb");
+	if (single == NULL || batched == NULL) {
+		fprintf(stderr, "Unable to read: %s\n", args[1]);
+		return 1;
+	}
+
+	light_packet_batch* batch = light_create_packet_batch(BATCH_SIZE);
+	int index = 0;
+	int res = 0;
+
+	while (res == 0) {
+		int count = light_read_packets(batched, batch, BATCH_SIZE);
+		if (count < 0 || (size_t)count != batch->count) {
+			res = 1;
+			break;
+		}
+
+		for (int i = 0; i < count && res == 0; i++, index++) {
+			light_packet_interface pkt_interface = { 0 };
+			light_packet_interface batch_interface = { 0 };
+			light_packet_header pkt_header = { 0 };
+			const uint8_t* pkt_data = NULL;
+
+			if (light_read_packet(single, &pkt_interface, &pkt_header, &pkt_data) != 0) {
+				fprintf(stderr, "Packet #%d: missing from light_read_packet\n", index + 1);
+				res = 1;
+				break;
+			}
+			free(pkt_header.comment);
+			light_get_interface(batched, batch->interface_ids[i], &batch_interface);
+
+			if (pkt_header.timestamp.tv_sec != batch->timestamps[i].tv_sec ||
+				pkt_header.timestamp.tv_nsec != batch->timestamps[i].tv_nsec ||
+				pkt_header.captured_length != batch->captured_lengths[i] ||
+				pkt_header.original_length != batch->original_lengths[i] ||
+				pkt_header.flags != batch->flags[i] ||
+				pkt_interface.link_type != batch_interface.link_type ||
+				safe_strcmp(pkt_interface.name, batch_interface.name) != 0 ||
+				memcmp(pkt_data, batch->packet_data[i], pkt_header.captured_length) != 0)
+			{
+				fprintf(stderr, "Packet #%d: mismatch\n", index + 1);
+				res = 1;
+			}
+		}
+
+		if (count < BATCH_SIZE) {
+			break;
+		}
+	}
+
+	if (res == 0) {
+		// Both readers must reach the end together
+		light_packet_interface pkt_interface = { 0 };
+		light_packet_header pkt_header = { 0 };
+		const uint8_t* pkt_data = NULL;
+		if (light_read_packet(single, &pkt_interface, &pkt_header, &pkt_data) == 0) {
+			fprintf(stderr, "Packet #%d: missing from light_read_packets\n", index + 1);
+			free(pkt_header.comment);
+			res = 1;
+		}
+	}
+
+	light_free_packet_batch(batch);
+	light_pcapng_close(single);
+	light_pcapng_close(batched);
+
+	return res;
+}
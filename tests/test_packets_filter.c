@@ -0,0 +1,159 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Reads a capture once unfiltered and once through light_pcapng_set_filter,
+// the filtered reader must return exactly the packets matching the filter.
+
+#include "light_pcapng_ext.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BATCH_SIZE 64
+
+typedef struct packet_summary {
+	struct timespec timestamp;
+	uint32_t interface_id;
+	uint32_t captured_length;
+	uint32_t original_length;
+	uint32_t checksum;
+} packet_summary;
+
+static uint32_t checksum(const uint8_t* data, uint32_t length)
+{
+	uint32_t sum = 0;
+	for (uint32_t i = 0; i < length; i++) {
+		sum = sum * 31 + data[i];
+	}
+	return sum;
+}
+
+static int compare_ts(const struct timespec* a, const struct timespec* b)
+{
+	if (a->tv_sec != b->tv_sec) {
+		return a->tv_sec < b->tv_sec ? -1 : 1;
+	}
+	if (a->tv_nsec != b->tv_nsec) {
+		return a->tv_nsec < b->tv_nsec ? -1 : 1;
+	}
+	return 0;
+}
+
+static int matches(const light_packet_filter* filter, const packet_summary* packet)
+{
+	return packet->interface_id == filter->interface_ids[0]
+		&& compare_ts(&packet->timestamp, &filter->start) >= 0
+		&& compare_ts(&packet->timestamp, &filter->end) < 0
+		&& packet->captured_length >= filter->min_captured_length
+		&& packet->captured_length <= filter->max_captured_length;
+}
+
+int main(int argc, const char** args)
+{
+	if (argc != 2) {
+		fprintf(stderr, "Usage %s [infile]", args[0]);
+		return 1;
+	}
+
+	light_pcapng all = light_pcapng_open(args[1], "rb");
+	light_pcapng filtered = light_pcapng_open(args[1], "rb");
+	if (all == NULL || filtered == NULL) {
+		fprintf(stderr, "Unable to read: %s\n", args[1]);
+		return 1;
+	}
+
+	light_packet_batch* batch = light_create_packet_batch(BATCH_SIZE);
+	packet_summary* packets = NULL;
+	size_t count = 0;
+	int read;
+
+	while ((read = light_read_packets(all, batch, BATCH_SIZE)) > 0) {
+		packets = realloc(packets, (count + read) * sizeof(packet_summary));
+		for (int i = 0; i < read; i++) {
+			packet_summary* packet = &packets[count++];
+			packet->timestamp = batch->timestamps[i];
+			packet->interface_id = batch->interface_ids[i];
+			packet->captured_length = batch->captured_lengths[i];
+			packet->original_length = batch->original_lengths[i];
+			packet->checksum = checksum(batch->packet_data[i], batch->captured_lengths[i]);
+		}
+	}
+
+	int res = 0;
+	if (count > 0) {
+		// Window around the middle of the capture on the interface found there
+		uint32_t interface_id = packets[count / 2].interface_id;
+		light_packet_filter filter = { 0 };
+		filter.interface_ids = &interface_id;
+		filter.interface_count = 1;
+		filter.start = packets[count / 4].timestamp;
+		filter.end = packets[count * 3 / 4].timestamp;
+		filter.end.tv_nsec += 1;
+		filter.min_captured_length = 16;
+		filter.max_captured_length = 1500;
+		light_pcapng_set_filter(filtered, &filter);
+
+		size_t expected = 0;
+		for (size_t i = 0; i < count && res == 0; i++) {
+			if (!matches(&filter, &packets[i])) {
+				continue;
+			}
+			expected++;
+
+			light_packet_interface pkt_interface = { 0 };
+			light_packet_header pkt_header = { 0 };
+			const uint8_t* pkt_data = NULL;
+			if (light_read_packet(filtered, &pkt_interface, &pkt_header, &pkt_data) != 0) {
+				fprintf(stderr, "Packet #%zu: missing from the filtered reader\n", i + 1);
+				res = 1;
+				break;
+			}
+			free(pkt_header.comment);
+
+			if (compare_ts(&pkt_header.timestamp, &packets[i].timestamp) != 0 ||
+				pkt_header.captured_length != packets[i].captured_length ||
+				pkt_header.original_length != packets[i].original_length ||
+				checksum(pkt_data, pkt_header.captured_length) != packets[i].checksum)
+			{
+				fprintf(stderr, "Packet #%zu: mismatch\n", i + 1);
+				res = 1;
+			}
+		}
+
+		if (res == 0) {
+			light_packet_interface pkt_interface = { 0 };
+			light_packet_header pkt_header = { 0 };
+			const uint8_t* pkt_data = NULL;
+			if (light_read_packet(filtered, &pkt_interface, &pkt_header, &pkt_data) == 0) {
+				fprintf(stderr, "Filtered reader returned more than %zu packets\n", expected);
+				free(pkt_header.comment);
+				res = 1;
+			}
+		}
+	}
+
+	free(packets);
+	light_free_packet_batch(batch);
+	light_pcapng_close(all);
+	light_pcapng_close(filtered);
+
+	return res;
+}
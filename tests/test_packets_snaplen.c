@@ -0,0 +1,105 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Reads a capture in full and with a snapshot length, truncated packets must
+// keep their headers and options and carry a prefix of the full payload.
+
+#include "light_pcapng_ext.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "_util.h"
+
+static int check_snaplen(const char* infile, uint32_t snaplen)
+{
+	light_pcapng full = light_pcapng_open(infile, "rb");
+	light_pcapng truncated = light_pcapng_open(infile, "rb");
+	if (full == NULL || truncated == NULL) {
+		fprintf(stderr, "Unable to read: %s\n", infile);
+		return 1;
+	}
+	light_pcapng_set_snaplen(truncated, snaplen);
+
+	int index = 0;
+	int res = 0;
+	while (res == 0) {
+		light_packet_interface full_interface = { 0 };
+		light_packet_header full_header = { 0 };
+		const uint8_t* full_data = NULL;
+		light_packet_interface trunc_interface = { 0 };
+		light_packet_header trunc_header = { 0 };
+		const uint8_t* trunc_data = NULL;
+
+		int full_res = light_read_packet(full, &full_interface, &full_header, &full_data);
+		int trunc_res = light_read_packet(truncated, &trunc_interface, &trunc_header, &trunc_data);
+		index++;
+
+		if (full_res != trunc_res) {
+			fprintf(stderr, "Snaplen %u, packet #%d: only one reader found it\n", snaplen, index);
+			res = 1;
+		}
+		else if (full_res == 0) {
+			uint32_t expected_length = full_header.captured_length < snaplen ? full_header.captured_length : snaplen;
+			if (full_header.timestamp.tv_sec != trunc_header.timestamp.tv_sec ||
+				full_header.timestamp.tv_nsec != trunc_header.timestamp.tv_nsec ||
+				full_header.original_length != trunc_header.original_length ||
+				full_header.flags != trunc_header.flags ||
+				full_header.dropcount != trunc_header.dropcount ||
+				safe_strcmp(full_header.comment, trunc_header.comment) != 0 ||
+				full_interface.link_type != trunc_interface.link_type ||
+				trunc_header.captured_length != expected_length ||
+				memcmp(full_data, trunc_data, expected_length) != 0)
+			{
+				fprintf(stderr, "Snaplen %u, packet #%d: mismatch\n", snaplen, index);
+				res = 1;
+			}
+		}
+		free(full_header.comment);
+		free(trunc_header.comment);
+
+		if (full_res != 0) {
+			break;
+		}
+	}
+
+	light_pcapng_close(full);
+	light_pcapng_close(truncated);
+	return res;
+}
+
+int main(int argc, const char** args)
+{
+	if (argc != 2) {
+		fprintf(stderr, "Usage %s [infile]", args[0]);
+		return 1;
+	}
+
+	// Headers only, a usual flow accounting length and one that truncates nothing
+	if (check_snaplen(args[1], 0) != 0 ||
+		check_snaplen(args[1], 64) != 0 ||
+		check_snaplen(args[1], LIGHT_SNAPLEN_UNLIMITED) != 0)
+	{
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,135 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "light_pcapng.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int count_options(const light_block block)
+{
+	int count = 0;
+	for (light_option opt = block->options; opt != NULL; opt = opt->next_option) {
+		count++;
+	}
+	return count;
+}
+
+static int count_view_options(const light_block_view* view, bool swap_endianness)
+{
+	int count = 0;
+	const uint8_t* iter = view->options;
+	const uint8_t* end = view->options + view->options_length;
+	while (end - iter >= 4) {
+		uint16_t code, length;
+		memcpy(&code, iter, sizeof(code));
+		memcpy(&length, iter + 2, sizeof(length));
+		if (swap_endianness) {
+			code = (uint16_t)((code >> 8) | (code << 8));
+			length = (uint16_t)((length >> 8) | (length << 8));
+		}
+		count++;
+		if (code == 0) {
+			break;
+		}
+		iter += 4 + ((length + 3) & ~3);
+	}
+	return count;
+}
+
+int main(int argc, const char** args)
+{
+	if (argc != 2) {
+		fprintf(stderr, "Usage %s [infile]", args[0]);
+		return 1;
+	}
+
+	light_file file_block = light_io_open(args[1], "rb");
+	light_file file_view = light_io_open(args[1], "rb");
+	if (file_block == NULL || file_view == NULL) {
+		fprintf(stderr, "Unable to read: %s\n", args[1]);
+		return 1;
+	}
+
+	int res = 0;
+	int index = 0;
+	light_block block = NULL;
+	bool swap_block = false;
+	bool swap_view = false;
+	while (1) {
+		light_block_view view;
+		light_read_block(file_block, &block, &swap_block);
+		int view_res = light_read_block_view(file_view, &view, &swap_view);
+
+		if (block == NULL || view_res != LIGHT_SUCCESS) {
+			// Both readers must stop on the same block
+			res = (block == NULL) != (view_res != LIGHT_SUCCESS);
+			break;
+		}
+		index++;
+
+		if (block->type != view.type || block->total_length != view.total_length) {
+			fprintf(stderr, "Block #%d: header mismatch\n", index);
+			res = 1;
+			break;
+		}
+		if (view.body_length != view.total_length - 12) {
+			fprintf(stderr, "Block #%d: body length mismatch\n", index);
+			res = 1;
+			break;
+		}
+		if (count_options(block) != count_view_options(&view, swap_view)) {
+			fprintf(stderr, "Block #%d: options mismatch\n", index);
+			res = 1;
+			break;
+		}
+		light_option_index options;
+		light_index_options(&options, &view, swap_view);
+		for (uint16_t code = 1; code < LIGHT_OPTION_INDEX_SIZE; code++) {
+			uint16_t length = 0;
+			const uint8_t* data = light_index_find_option(&options, code, &length);
+			light_option opt = light_find_option(block, code);
+			if (!data != !opt || (opt && (opt->length != length || memcmp(opt->data, data, length) != 0))) {
+				fprintf(stderr, "Block #%d: option %u mismatch\n", index, code);
+				res = 1;
+			}
+		}
+		if (res != 0) {
+			break;
+		}
+		if (block->type == LIGHT_ENHANCED_PACKET_BLOCK) {
+			struct _light_enhanced_packet_block* epb = (struct _light_enhanced_packet_block*)block->body;
+			const uint8_t* data = view.body + sizeof(struct _light_enhanced_packet_block);
+			if (memcmp(epb->packet_data, data, epb->capture_packet_length) != 0) {
+				fprintf(stderr, "Block #%d: packet data mismatch\n", index);
+				res = 1;
+				break;
+			}
+		}
+	}
+
+	light_free_block(block);
+	light_io_close(file_block);
+	light_io_close(file_view);
+
+	return res;
+}
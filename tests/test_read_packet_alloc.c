@@ -0,0 +1,191 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// Reads packets in LIGHT_READ_BORROWED mode and fails if the reader touches the
+// heap once it has seen every packet size and comment length of the capture.
+// Allocations are counted by interposing the glibc allocator, other platforms
+// skip the test.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "light_pcapng_ext.h"
+
+#define NUM_PACKETS 256
+#define WARMUP_PACKETS 16
+#define SKIP_RETURN_CODE 77
+
+#if defined(__GLIBC__)
+
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void __libc_free(void* ptr);
+
+static size_t allocations = 0;
+
+void* malloc(size_t size)
+{
+	allocations++;
+	return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+	allocations++;
+	return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+	allocations++;
+	return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr)
+{
+	if (ptr) {
+		allocations++;
+	}
+	__libc_free(ptr);
+}
+
+static uint32_t packet_length(int index)
+{
+	// Cycle through WARMUP_PACKETS different sizes
+	return 64 + (index % WARMUP_PACKETS) * 96;
+}
+
+static int write_packets(const char* filename)
+{
+	light_pcapng writer = light_pcapng_open(filename, "wb");
+	if (writer == NULL) {
+		fprintf(stderr, "Unable to write: %s\n", filename);
+		return -1;
+	}
+
+	light_packet_interface iface = { 0 };
+	iface.link_type = 1; // ETHERNET
+	iface.name = "interface1";
+	iface.timestamp_resolution = 1000000000;
+
+	uint8_t data[2048];
+	char comment[64];
+	for (int i = 0; i < NUM_PACKETS; i++) {
+		light_packet_header header = { 0 };
+		struct timespec ts = { 1627228100 + i, 5000 };
+		header.timestamp = ts;
+		header.captured_length = packet_length(i);
+		header.original_length = packet_length(i);
+		if (i % 2 == 0) {
+			snprintf(comment, sizeof(comment), "packet %*d", i % WARMUP_PACKETS, i);
+			header.comment = comment;
+		}
+		memset(data, i & 0xFF, header.captured_length);
+		light_write_packet(writer, &iface, &header, data);
+	}
+
+	light_pcapng_close(writer);
+	return 0;
+}
+
+int main(int argc, const char** args)
+{
+	if (argc != 2) {
+		fprintf(stderr, "Usage %s [outfile]", args[0]);
+		return 1;
+	}
+
+	if (write_packets(args[1]) != 0) {
+		return 1;
+	}
+
+	light_pcapng reader = light_pcapng_open(args[1], "rb");
+	if (reader == NULL) {
+		fprintf(stderr, "Unable to read: %s\n", args[1]);
+		return 1;
+	}
+	light_pcapng_set_read_flags(reader, LIGHT_READ_BORROWED);
+
+	int index = 0;
+	int res = 0;
+	size_t steady_allocations = 0;
+	char expected[64];
+	light_packet_interface iface = { 0 };
+	light_packet_header header = { 0 };
+	const uint8_t* data = NULL;
+
+	while (1) {
+		size_t before = allocations;
+		if (light_read_packet(reader, &iface, &header, &data) != 0 || data == NULL) {
+			break;
+		}
+		if (index >= WARMUP_PACKETS) {
+			steady_allocations += allocations - before;
+		}
+
+		if (header.captured_length != packet_length(index) || data[0] != (index & 0xFF)) {
+			res = 1;
+			break;
+		}
+		if (index % 2 == 0) {
+			snprintf(expected, sizeof(expected), "packet %*d", index % WARMUP_PACKETS, index);
+			if (header.comment == NULL || strcmp(header.comment, expected) != 0 || header.comment_length != strlen(expected)) {
+				res = 1;
+				break;
+			}
+		}
+		else if (header.comment != NULL) {
+			res = 1;
+			break;
+		}
+		index++;
+	}
+
+	light_pcapng_close(reader);
+
+	if (res != 0) {
+		fprintf(stderr, "Packet #%d does not match what was written\n", index + 1);
+		return 1;
+	}
+	if (index != NUM_PACKETS) {
+		fprintf(stderr, "Read %d packets, expected %d\n", index, NUM_PACKETS);
+		return 1;
+	}
+	if (steady_allocations != 0) {
+		fprintf(stderr, "%zu heap calls after %d packets\n", steady_allocations, WARMUP_PACKETS);
+		return 1;
+	}
+
+	return 0;
+}
+
+#else
+
+int main(int argc, const char** args)
+{
+	// Allocator interposition is only wired up for glibc
+	return SKIP_RETURN_CODE;
+}
+
+#endif
@@ -0,0 +1,204 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Reads a capture with light_pcapng_read_parallel, in order and per worker,
+// and checks every packet against light_read_packet.
+
+#include "light_pcapng_ext.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WORKERS 4
+
+typedef struct packet_summary {
+	struct timespec timestamp;
+	uint32_t interface_id;
+	uint32_t captured_length;
+	uint32_t checksum;
+	uint16_t link_type;
+} packet_summary;
+
+typedef struct read_state {
+	packet_summary* packets;
+	size_t count;
+	size_t next;
+	int errors;
+
+	// Per worker, so that workers never share a counter
+	size_t worker_count[WORKERS];
+	uint64_t worker_sum[WORKERS];
+} read_state;
+
+static uint32_t checksum(const uint8_t* data, uint32_t length, const char* comment)
+{
+	uint32_t sum = 0;
+	for (uint32_t i = 0; i < length; i++) {
+		sum = sum * 31 + data[i];
+	}
+	for (; comment != NULL && *comment; comment++) {
+		sum = sum * 31 + (uint8_t)*comment;
+	}
+	return sum;
+}
+
+static bool same_packet(const packet_summary* packet, uint32_t interface_id, const light_packet_interface* packet_interface, const light_packet_header* packet_header, const uint8_t* packet_data)
+{
+	return packet->timestamp.tv_sec == packet_header->timestamp.tv_sec
+		&& packet->timestamp.tv_nsec == packet_header->timestamp.tv_nsec
+		&& packet->interface_id == interface_id
+		&& packet->captured_length == packet_header->captured_length
+		&& packet->checksum == checksum(packet_data, packet_header->captured_length, packet_header->comment)
+		&& packet_interface != NULL && packet->link_type == packet_interface->link_type;
+}
+
+static int ordered_callback(void* context, uint32_t worker, uint32_t interface_id, const light_packet_interface* packet_interface, const light_packet_header* packet_header, const uint8_t* packet_data)
+{
+	read_state* state = context;
+	(void)worker;
+	if (state->next >= state->count || !same_packet(&state->packets[state->next], interface_id, packet_interface, packet_header, packet_data)) {
+		fprintf(stderr, "Ordered read: packet #%zu mismatch\n", state->next + 1);
+		state->errors++;
+		return 1;
+	}
+	state->next++;
+	return 0;
+}
+
+static uint64_t packet_key(uint32_t interface_id, const struct timespec* timestamp, uint32_t checksum)
+{
+	return ((uint64_t)interface_id << 48) ^ ((uint64_t)timestamp->tv_sec << 20) ^ (uint64_t)timestamp->tv_nsec ^ ((uint64_t)checksum << 16);
+}
+
+static int unordered_callback(void* context, uint32_t worker, uint32_t interface_id, const light_packet_interface* packet_interface, const light_packet_header* packet_header, const uint8_t* packet_data)
+{
+	read_state* state = context;
+	if (worker >= WORKERS || packet_interface == NULL) {
+		return 1;
+	}
+	// Packets arrive in any order, compare the sum of their keys at the end
+	uint32_t sum = checksum(packet_data, packet_header->captured_length, packet_header->comment);
+	state->worker_count[worker]++;
+	state->worker_sum[worker] += packet_key(interface_id, &packet_header->timestamp, sum);
+	return 0;
+}
+
+static int stop_callback(void* context, uint32_t worker, uint32_t interface_id, const light_packet_interface* packet_interface, const light_packet_header* packet_header, const uint8_t* packet_data)
+{
+	read_state* state = context;
+	(void)worker; (void)interface_id; (void)packet_interface; (void)packet_header; (void)packet_data;
+	return ++state->next == 2 ? 42 : 0;
+}
+
+int main(int argc, const char** args)
+{
+	if (argc != 2) {
+		fprintf(stderr, "Usage %s [infile]", args[0]);
+		return 1;
+	}
+
+	light_pcapng pcapng = light_pcapng_open(args[1], "rb");
+	if (pcapng == NULL) {
+		fprintf(stderr, "Unable to read: %s\n", args[1]);
+		return 1;
+	}
+	light_packet_batch* batch = light_create_packet_batch(1);
+	read_state state = { 0 };
+	while (light_read_packets(pcapng, batch, 1) == 1) {
+		// The batch reports interface ids, light_read_packet the comment
+		light_packet_interface pkt_interface = { 0 };
+		light_get_interface(pcapng, batch->interface_ids[0], &pkt_interface);
+		state.packets = realloc(state.packets, (state.count + 1) * sizeof(packet_summary));
+		packet_summary* packet = &state.packets[state.count++];
+		memset(packet, 0, sizeof(*packet));
+		packet->timestamp = batch->timestamps[0];
+		packet->interface_id = batch->interface_ids[0];
+		packet->captured_length = batch->captured_lengths[0];
+		packet->checksum = checksum(batch->packet_data[0], batch->captured_lengths[0], NULL);
+		packet->link_type = pkt_interface.link_type;
+	}
+	light_free_packet_batch(batch);
+	light_pcapng_close(pcapng);
+
+	// Fold the comments in with a second sequential pass
+	pcapng = light_pcapng_open(args[1], "rb");
+	for (size_t i = 0; i < state.count; i++) {
+		light_packet_interface pkt_interface = { 0 };
+		light_packet_header pkt_header = { 0 };
+		const uint8_t* pkt_data = NULL;
+		light_read_packet(pcapng, &pkt_interface, &pkt_header, &pkt_data);
+		state.packets[i].checksum = checksum(pkt_data, pkt_header.captured_length, pkt_header.comment);
+		free(pkt_header.comment);
+	}
+	light_pcapng_close(pcapng);
+
+	int res = 0;
+
+	// Tiny chunks, so that most of them start in the middle of a block
+	size_t chunk_sizes[] = { 0, 256, 1000 };
+	for (size_t c = 0; c < sizeof(chunk_sizes) / sizeof(chunk_sizes[0]) && res == 0; c++) {
+		state.next = 0;
+		state.errors = 0;
+		if (light_pcapng_read_parallel(args[1], WORKERS, chunk_sizes[c], LIGHT_PARALLEL_ORDERED, ordered_callback, &state) != 0
+			|| state.errors != 0 || state.next != state.count) {
+			fprintf(stderr, "Ordered read with chunks of %zu: %zu of %zu packets\n", chunk_sizes[c], state.next, state.count);
+			res = 1;
+		}
+
+		memset(state.worker_count, 0, sizeof(state.worker_count));
+		memset(state.worker_sum, 0, sizeof(state.worker_sum));
+		if (res == 0 && light_pcapng_read_parallel(args[1], WORKERS, chunk_sizes[c], 0, unordered_callback, &state) != 0) {
+			fprintf(stderr, "Unordered read with chunks of %zu failed\n", chunk_sizes[c]);
+			res = 1;
+		}
+		size_t count = 0;
+		uint64_t sum = 0;
+		for (size_t w = 0; w < WORKERS; w++) {
+			count += state.worker_count[w];
+			sum += state.worker_sum[w];
+		}
+		for (size_t i = 0; i < state.count; i++) {
+			sum -= packet_key(state.packets[i].interface_id, &state.packets[i].timestamp, state.packets[i].checksum);
+		}
+		if (res == 0 && (count != state.count || sum != 0)) {
+			fprintf(stderr, "Unordered read with chunks of %zu: %zu of %zu packets\n", chunk_sizes[c], count, state.count);
+			res = 1;
+		}
+	}
+
+	// The callback result comes back and nothing gets delivered after it
+	state.next = 0;
+	if (res == 0 && state.count >= 2) {
+		if (light_pcapng_read_parallel(args[1], WORKERS, 256, LIGHT_PARALLEL_ORDERED, stop_callback, &state) != 42 || state.next != 2) {
+			fprintf(stderr, "Stopping did not work\n");
+			res = 1;
+		}
+	}
+
+	// Anything not starting with a section header is turned down, as light_pcapng_open does
+	if (res == 0 && light_pcapng_read_parallel(args[0], WORKERS, 0, LIGHT_PARALLEL_ORDERED, ordered_callback, &state) == 0) {
+		fprintf(stderr, "Read a file that is no capture: %s\n", args[0]);
+		res = 1;
+	}
+
+	free(state.packets);
+	return res;
+}
@@ -0,0 +1,219 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Damages one packet block of a capture in a few ways, and checks that
+// light_pcapng_resync lets the reader get every other packet back.
+
+#include "light_pcapng_ext.h"
+#include "light_pcapng.h"
+#include "light_io.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct packet_summary {
+	struct timespec timestamp;
+	uint32_t captured_length;
+} packet_summary;
+
+static uint8_t* read_all(const char* path, size_t* size)
+{
+	light_file file = light_io_open(path, "rb");
+	if (file == NULL) {
+		return NULL;
+	}
+	uint8_t* data = NULL;
+	*size = 0;
+	size_t read;
+	do {
+		data = realloc(data, *size + 65536);
+		read = light_io_read(file, data + *size, 65536);
+		*size += read;
+	} while (read == 65536);
+	light_io_close(file);
+	return data;
+}
+
+static int write_all(const char* path, const uint8_t* data, size_t size)
+{
+	light_file file = light_io_open(path, "wb");
+	if (file == NULL) {
+		return 1;
+	}
+	size_t written = light_io_write(file, data, size);
+	light_io_close(file);
+	return written != size;
+}
+
+// Reads every packet, resyncing on failures, returns the number of resyncs or -1
+static int read_packets(const char* path, packet_summary* packets, size_t* count)
+{
+	light_pcapng pcapng = light_pcapng_open(path, "rb");
+	if (pcapng == NULL) {
+		return -1;
+	}
+	int resyncs = 0;
+	*count = 0;
+	while (1) {
+		light_packet_interface pkt_interface = { 0 };
+		light_packet_header pkt_header = { 0 };
+		const uint8_t* pkt_data = NULL;
+		if (light_read_packet(pcapng, &pkt_interface, &pkt_header, &pkt_data) != 0) {
+			if (light_pcapng_resync(pcapng) != 0) {
+				break;
+			}
+			resyncs++;
+			continue;
+		}
+		free(pkt_header.comment);
+		packets[*count].timestamp = pkt_header.timestamp;
+		packets[*count].captured_length = pkt_header.captured_length;
+		(*count)++;
+	}
+	light_pcapng_close(pcapng);
+	return resyncs;
+}
+
+static uint32_t get32(const uint8_t* data, bool swap)
+{
+	uint32_t value;
+	memcpy(&value, data, sizeof(value));
+	return swap ? ((value >> 24) | ((value >> 8) & 0xFF00) | ((value << 8) & 0xFF0000) | (value << 24)) : value;
+}
+
+static void put32(uint8_t* data, uint32_t value, bool swap)
+{
+	if (swap) {
+		value = (value >> 24) | ((value >> 8) & 0xFF00) | ((value << 8) & 0xFF0000) | (value << 24);
+	}
+	memcpy(data, &value, sizeof(value));
+}
+
+int main(int argc, const char** args)
+{
+	if (argc != 3) {
+		fprintf(stderr, "Usage %s [infile] [outprefix]", args[0]);
+		return 1;
+	}
+
+	size_t size;
+	uint8_t* data = read_all(args[1], &size);
+	if (data == NULL) {
+		fprintf(stderr, "Unable to read: %s\n", args[1]);
+		return 1;
+	}
+
+	// Packet blocks, found by walking the capture
+	size_t packet_blocks = 0;
+	size_t* offsets = malloc(sizeof(size_t) * (size / 12 + 1));
+	size_t damaged = 0;
+	bool swap = false;
+	for (size_t offset = 0; offset < size; offset += get32(data + offset + 4, swap)) {
+		if (light_find_block(data, size, offset, &swap) != offset) {
+			fprintf(stderr, "Block at %zu not found by light_find_block\n", offset);
+			return 1;
+		}
+		uint32_t type = get32(data + offset, swap);
+		if (type == LIGHT_ENHANCED_PACKET_BLOCK || type == LIGHT_SIMPLE_PACKET_BLOCK) {
+			offsets[packet_blocks++] = offset;
+		}
+	}
+	if (packet_blocks < 3) {
+		free(offsets);
+		free(data);
+		return 0;
+	}
+	damaged = offsets[packet_blocks / 2];
+	uint32_t length = get32(data + damaged + 4, swap);
+	free(offsets);
+
+	packet_summary* expected = malloc(sizeof(packet_summary) * packet_blocks);
+	packet_summary* actual = malloc(sizeof(packet_summary) * packet_blocks);
+	size_t expected_count;
+	read_packets(args[1], expected, &expected_count);
+	// The damaged packet is the only one lost
+	memmove(expected + packet_blocks / 2, expected + packet_blocks / 2 + 1, (expected_count - packet_blocks / 2 - 1) * sizeof(packet_summary));
+	expected_count--;
+
+	typedef struct damage {
+		const char* name;
+		uint32_t offset;
+		uint32_t value;
+	} damage;
+	// A bad trailer, a length running over the next blocks and a length that is not even aligned
+	damage damages[] = {
+		{ "trailer", length - 4, 0xDEADBEEF },
+		{ "length", 4, length + 64 },
+		{ "unaligned", 4, length + 2 },
+	};
+
+	// Plain files seek back to the damaged block, zstd cannot and goes on from where the read stopped
+	const char* suffixes[] = { ".pcapng", ".pcapng.zst" };
+
+	int res = 0;
+	char path[4096];
+	for (size_t d = 0; d < sizeof(damages) / sizeof(damages[0]) && res == 0; d++) {
+		uint32_t original = get32(data + damaged + damages[d].offset, swap);
+		put32(data + damaged + damages[d].offset, damages[d].value, swap);
+
+		for (size_t s = 0; s < sizeof(suffixes) / sizeof(suffixes[0]) && res == 0; s++) {
+#if !defined(LIGHT_USE_ZSTD)
+			if (strstr(suffixes[s], ".zst")) {
+				continue;
+			}
+#endif
+			// Without seeking, an overlong length swallows the blocks behind it
+			if (s == 1 && d == 1) {
+				continue;
+			}
+			snprintf(path, sizeof(path), "%s.%s%s", args[2], damages[d].name, suffixes[s]);
+			if (write_all(path, data, size) != 0) {
+				fprintf(stderr, "Unable to write: %s\n", path);
+				res = 1;
+				break;
+			}
+
+			size_t actual_count;
+			int resyncs = read_packets(path, actual, &actual_count);
+			if (resyncs != 1 || actual_count != expected_count) {
+				fprintf(stderr, "%s: %d resyncs, %zu of %zu packets\n", path, resyncs, actual_count, expected_count);
+				res = 1;
+				break;
+			}
+			for (size_t i = 0; i < actual_count; i++) {
+				if (actual[i].timestamp.tv_sec != expected[i].timestamp.tv_sec ||
+					actual[i].timestamp.tv_nsec != expected[i].timestamp.tv_nsec ||
+					actual[i].captured_length != expected[i].captured_length) {
+					fprintf(stderr, "%s: packet #%zu mismatch\n", path, i + 1);
+					res = 1;
+					break;
+				}
+			}
+		}
+
+		put32(data + damaged + damages[d].offset, original, swap);
+	}
+
+	free(expected);
+	free(actual);
+	free(data);
+	return res;
+}
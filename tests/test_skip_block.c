@@ -0,0 +1,96 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "light_pcapng.h"
+
+#include <stdio.h>
+
+int main(int argc, const char** args) {
+
+	if (argc != 2) {
+		fprintf(stderr, "Usage %s [infile]", args[0]);
+		return 1;
+	}
+
+	const char* infile = args[1];
+	light_file reference = light_io_open(infile, "rb");
+	light_file skipping = light_io_open(infile, "rb");
+	if (reference == NULL || skipping == NULL) {
+		fprintf(stderr, "Unable to open pcapng: %s\n", infile);
+		return 1;
+	}
+
+	bool reference_swap = false;
+	bool skipping_swap = false;
+	light_block block = NULL;
+	int index = 0;
+	int res = 0;
+
+	while (1) {
+		light_read_block(reference, &block, &reference_swap);
+		if (block == NULL) {
+			break;
+		}
+
+		uint32_t type, length, again_type, again_length;
+		if (light_peek_block_header(skipping, &type, &length, &skipping_swap) != LIGHT_SUCCESS
+			|| light_peek_block_header(skipping, &again_type, &again_length, &skipping_swap) != LIGHT_SUCCESS) {
+			fprintf(stderr, "Block %d: peek failed\n", index);
+			res = 1;
+			break;
+		}
+		if (type != block->type || length != block->total_length || again_type != type || again_length != length) {
+			fprintf(stderr, "Block %d: peeked %08x/%u, expected %08x/%u\n",
+				index, type, length, block->type, block->total_length);
+			res = 1;
+			break;
+		}
+
+		// Alternate so that reads after a skip land on the right boundary
+		if (index % 2 == 0) {
+			res = light_skip_block(skipping, &skipping_swap);
+		}
+		else {
+			light_block_view view;
+			res = light_read_block_view(skipping, &view, &skipping_swap);
+			if (res == LIGHT_SUCCESS && (view.type != type || view.total_length != length)) {
+				res = LIGHT_FAILURE;
+			}
+		}
+		if (res != LIGHT_SUCCESS) {
+			fprintf(stderr, "Block %d: unable to move past it\n", index);
+			res = 1;
+			break;
+		}
+		index++;
+	}
+
+	uint32_t type, length;
+	if (res == 0 && light_peek_block_header(skipping, &type, &length, &skipping_swap) == LIGHT_SUCCESS) {
+		fprintf(stderr, "Extra block after %d blocks\n", index);
+		res = 1;
+	}
+
+	light_free_block(block);
+	light_io_close(reference);
+	light_io_close(skipping);
+
+	return res;
+}
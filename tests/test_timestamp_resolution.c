@@ -0,0 +1,149 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Writes packets on interfaces of decimal and binary resolutions, then checks that
+// resolutions, timestamps and raw ticks read back as written.
+
+#include "light_pcapng_ext.h"
+#include "light_pcapng.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NSEC_PER_SEC 1000000000ull
+#define INTERFACE_COUNT 7
+#define PACKET_COUNT 64
+
+// Resolution written, and the one read back: 0 is microseconds, 1500 is rounded up to 10^4
+static const uint64_t written[INTERFACE_COUNT] = { 0, 1000, 1000000, NSEC_PER_SEC, 1024, 1ull << 30, 1500 };
+static const uint64_t expected[INTERFACE_COUNT] = { 1000000, 1000, 1000000, NSEC_PER_SEC, 1024, 1ull << 30, 10000 };
+
+static struct timespec packet_time(int p)
+{
+	struct timespec ts;
+	ts.tv_sec = 1700000000 + p * 3;
+	ts.tv_nsec = (long)((p * 123456789ull + 987) % NSEC_PER_SEC);
+	return ts;
+}
+
+static uint64_t packet_ticks(int p, uint64_t resolution)
+{
+	struct timespec ts = packet_time(p);
+	return (uint64_t)ts.tv_sec * resolution + (uint64_t)ts.tv_nsec * resolution / NSEC_PER_SEC;
+}
+
+// The written timestamp truncated to the interface resolution
+static struct timespec packet_truncated(int p, uint64_t resolution)
+{
+	struct timespec ts = packet_time(p);
+	uint64_t fraction = (uint64_t)ts.tv_nsec * resolution / NSEC_PER_SEC;
+	ts.tv_nsec = (long)(fraction * NSEC_PER_SEC / resolution);
+	return ts;
+}
+
+static int check(const char* path, uint32_t flags)
+{
+	light_pcapng reader = light_pcapng_open(path, "rb");
+	if (reader == NULL) {
+		fprintf(stderr, "Unable to read: %s\n", path);
+		return 1;
+	}
+	light_pcapng_set_read_flags(reader, flags);
+
+	int p = 0;
+	light_packet_interface iface = { 0 };
+	light_packet_header header = { 0 };
+	const uint8_t* data = NULL;
+	while (light_read_packet(reader, &iface, &header, &data) == LIGHT_SUCCESS && data != NULL) {
+		int i = data[0];
+		if (iface.timestamp_resolution != expected[i]) {
+			fprintf(stderr, "Interface %d resolution %llu instead of %llu\n", i,
+				(unsigned long long)iface.timestamp_resolution, (unsigned long long)expected[i]);
+			return 1;
+		}
+		if (header.timestamp_ticks != packet_ticks(p, expected[i])) {
+			fprintf(stderr, "Packet #%d has %llu ticks\n", p + 1, (unsigned long long)header.timestamp_ticks);
+			return 1;
+		}
+		struct timespec ts = packet_truncated(p, expected[i]);
+		if (!(flags & LIGHT_READ_RAW_TIMESTAMPS) &&
+			(header.timestamp.tv_sec != ts.tv_sec || header.timestamp.tv_nsec != ts.tv_nsec)) {
+			fprintf(stderr, "Packet #%d at %lld.%09ld instead of %lld.%09ld\n", p + 1,
+				(long long)header.timestamp.tv_sec, header.timestamp.tv_nsec, (long long)ts.tv_sec, ts.tv_nsec);
+			return 1;
+		}
+		free(header.comment);
+		p++;
+	}
+	light_pcapng_close(reader);
+
+	if (p != PACKET_COUNT) {
+		fprintf(stderr, "%d packets read back\n", p);
+		return 1;
+	}
+	return 0;
+}
+
+int main(int argc, const char** args)
+{
+	if (argc != 2) {
+		fprintf(stderr, "Usage %s [outfile]", args[0]);
+		return 1;
+	}
+	const char* path = args[1];
+
+	light_pcapng writer = light_pcapng_open(path, "wb");
+	if (writer == NULL) {
+		fprintf(stderr, "Unable to write: %s\n", path);
+		return 1;
+	}
+	int handles[INTERFACE_COUNT];
+	for (int i = 0; i < INTERFACE_COUNT; i++) {
+		light_packet_interface iface = { 0 };
+		iface.link_type = 1;
+		iface.timestamp_resolution = written[i];
+		handles[i] = light_write_interface_block(writer, &iface);
+		if (handles[i] < 0) {
+			fprintf(stderr, "Interface %d not written: %d\n", i, handles[i]);
+			return 1;
+		}
+	}
+
+	uint8_t data[1];
+	light_packet_header header = { 0 };
+	header.captured_length = sizeof(data);
+	header.original_length = sizeof(data);
+	for (int p = 0; p < PACKET_COUNT; p++) {
+		int i = p % INTERFACE_COUNT;
+		data[0] = (uint8_t)i;
+		header.timestamp = packet_time(p);
+		if (light_write_packet_on(writer, handles[i], &header, data) != LIGHT_SUCCESS) {
+			fprintf(stderr, "Packet #%d not written\n", p + 1);
+			return 1;
+		}
+	}
+	light_pcapng_close(writer);
+
+	if (check(path, 0) != 0 || check(path, LIGHT_READ_RAW_TIMESTAMPS) != 0) {
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,164 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Writes packets on many interfaces through handles and through interface lookups,
+// then checks that every interface block was written once and packets point to the right one.
+
+#include "light_pcapng_ext.h"
+#include "light_pcapng.h"
+#include "light_io_mem.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INTERFACE_COUNT 300
+#define PACKET_COUNT 3000
+
+static void make_interface(light_packet_interface* iface, char* name, size_t name_size, int index)
+{
+	snprintf(name, name_size, "if%d", index);
+	memset(iface, 0, sizeof(*iface));
+	iface->link_type = 1;
+	iface->name = name;
+	// A few share the name but differ in description or resolution
+	iface->description = index % 3 == 0 ? "even" : NULL;
+	iface->timestamp_resolution = index % 2 == 0 ? 0 : 1000000000;
+}
+
+// Number of interfaces and packets read back, -1 on mismatch
+static int check(const char* path, size_t* interface_count, size_t* packet_count)
+{
+	light_pcapng reader = light_pcapng_open(path, "rb");
+	if (reader == NULL) {
+		return -1;
+	}
+	*packet_count = 0;
+	int res = 0;
+	while (res == 0) {
+		light_packet_interface iface = { 0 };
+		light_packet_header header = { 0 };
+		const uint8_t* data = NULL;
+		if (light_read_packet(reader, &iface, &header, &data) != 0 || data == NULL) {
+			break;
+		}
+		// Each packet carries the index of the interface it was written on
+		char expected[32];
+		snprintf(expected, sizeof(expected), "if%u", data[0] | (data[1] << 8));
+		if (iface.name == NULL || strcmp(iface.name, expected) != 0) {
+			fprintf(stderr, "Packet #%zu on %s instead of %s\n", *packet_count + 1, iface.name, expected);
+			res = -1;
+		}
+		free(header.comment);
+		(*packet_count)++;
+	}
+	light_packet_interface iface;
+	*interface_count = 0;
+	while (light_get_interface(reader, (uint32_t)*interface_count, &iface) == LIGHT_SUCCESS) {
+		(*interface_count)++;
+	}
+	light_pcapng_close(reader);
+	return res;
+}
+
+int main(int argc, const char** args)
+{
+	if (argc != 2) {
+		fprintf(stderr, "Usage %s [outfile]", args[0]);
+		return 1;
+	}
+	const char* path = args[1];
+
+	char names[INTERFACE_COUNT][16];
+	light_packet_interface interfaces[INTERFACE_COUNT];
+	int handles[INTERFACE_COUNT];
+
+	light_pcapng writer = light_pcapng_open(path, "wb");
+	if (writer == NULL) {
+		fprintf(stderr, "Unable to write: %s\n", path);
+		return 1;
+	}
+	for (int i = 0; i < INTERFACE_COUNT; i++) {
+		make_interface(&interfaces[i], names[i], sizeof(names[i]), i);
+		handles[i] = light_write_interface_block(writer, &interfaces[i]);
+		if (handles[i] < 0) {
+			fprintf(stderr, "Interface %d not written: %d\n", i, handles[i]);
+			return 1;
+		}
+	}
+
+	// Alternating between handles and lookups, which must find the interfaces written above
+	uint8_t data[2];
+	light_packet_header header = { 0 };
+	header.captured_length = sizeof(data);
+	header.original_length = sizeof(data);
+	for (int p = 0; p < PACKET_COUNT; p++) {
+		int i = (p * 7) % INTERFACE_COUNT;
+		data[0] = i & 0xFF;
+		data[1] = (uint8_t)(i >> 8);
+		int res = p % 2 == 0
+			? light_write_packet_on(writer, handles[i], &header, data)
+			: light_write_packet(writer, &interfaces[i], &header, data);
+		if (res != LIGHT_SUCCESS) {
+			fprintf(stderr, "Packet #%d not written: %d\n", p + 1, res);
+			return 1;
+		}
+	}
+	if (light_write_packet_on(writer, INTERFACE_COUNT, &header, data) != LIGHT_INVALID_ARGUMENT) {
+		fprintf(stderr, "Unknown handle accepted\n");
+		return 1;
+	}
+	light_pcapng_close(writer);
+
+	// Appending looks the interfaces up in what was read from the file
+	writer = light_pcapng_open(path, "a+");
+	if (writer == NULL) {
+		fprintf(stderr, "Unable to append: %s\n", path);
+		return 1;
+	}
+	for (int i = 0; i < INTERFACE_COUNT; i++) {
+		data[0] = i & 0xFF;
+		data[1] = (uint8_t)(i >> 8);
+		if (light_write_packet(writer, &interfaces[i], &header, data) != LIGHT_SUCCESS) {
+			fprintf(stderr, "Packet on interface %d not appended\n", i);
+			return 1;
+		}
+	}
+	light_pcapng_close(writer);
+
+	size_t interface_count, packet_count;
+	if (check(path, &interface_count, &packet_count) != 0) {
+		return 1;
+	}
+	if (interface_count != INTERFACE_COUNT || packet_count != PACKET_COUNT + INTERFACE_COUNT) {
+		fprintf(stderr, "%zu interfaces and %zu packets read back\n", interface_count, packet_count);
+		return 1;
+	}
+
+	// No handle for an interface whose block did not fit in the file
+	uint8_t memory[16];
+	writer = light_pcapng_create(light_io_mem_create(memory, sizeof(memory)), "wb", NULL);
+	if (writer == NULL || light_write_interface_block(writer, &interfaces[0]) >= 0) {
+		fprintf(stderr, "Interface written to a full file\n");
+		return 1;
+	}
+	light_pcapng_close(writer);
+	return 0;
+}
@@ -0,0 +1,152 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Writes a capture once packet by packet and once in batches of packets of the same interface,
+// both files have to come out byte for byte the same.
+
+#include "light_pcapng_ext.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "_util.h"
+
+// Small on purpose, so batches also end in the middle of an interface run
+#define BATCH_SIZE 5
+
+typedef struct packet {
+	light_packet_interface interface;
+	light_packet_header header;
+	uint8_t* data;
+} packet;
+
+static int same_interface(const light_packet_interface* a, const light_packet_interface* b)
+{
+	return a->link_type == b->link_type
+		&& a->timestamp_resolution == b->timestamp_resolution
+		&& safe_strcmp(a->name, b->name) == 0
+		&& safe_strcmp(a->description, b->description) == 0;
+}
+
+static uint8_t* read_file(const char* path, size_t* size)
+{
+	FILE* file = fopen(path, "rb");
+	if (file == NULL) {
+		return NULL;
+	}
+	fseek(file, 0, SEEK_END);
+	*size = (size_t)ftell(file);
+	fseek(file, 0, SEEK_SET);
+	uint8_t* data = malloc(*size + 1);
+	if (fread(data, 1, *size, file) != *size) {
+		free(data);
+		data = NULL;
+	}
+	fclose(file);
+	return data;
+}
+
+int main(int argc, const char** args)
+{
+	if (argc != 3) {
+		fprintf(stderr, "Usage %s [infile] [outprefix]", args[0]);
+		return 1;
+	}
+
+	// Interfaces of the packets point into the reader, it stays open until the end
+	light_pcapng reader = light_pcapng_open(args[1], "rb");
+	if (reader == NULL) {
+		fprintf(stderr, "Unable to read: %s\n", args[1]);
+		return 1;
+	}
+	size_t count = 0;
+	size_t capacity = 64;
+	packet* packets = malloc(capacity * sizeof(packet));
+	while (1) {
+		const uint8_t* data = NULL;
+		if (count == capacity) {
+			capacity *= 2;
+			packets = realloc(packets, capacity * sizeof(packet));
+		}
+		packet* current = &packets[count];
+		if (light_read_packet(reader, &current->interface, &current->header, &data) != 0 || data == NULL) {
+			break;
+		}
+		current->data = malloc(current->header.captured_length + 1);
+		memcpy(current->data, data, current->header.captured_length);
+		count++;
+	}
+
+	char single_path[4096];
+	char batched_path[4096];
+	snprintf(single_path, sizeof(single_path), "%s.single.pcapng", args[2]);
+	snprintf(batched_path, sizeof(batched_path), "%s.batched.pcapng", args[2]);
+
+	int res = 0;
+	light_pcapng single = light_pcapng_open(single_path, "wb");
+	light_pcapng batched = light_pcapng_open(batched_path, "wb");
+	if (single == NULL || batched == NULL) {
+		fprintf(stderr, "Unable to write: %s\n", args[2]);
+		return 1;
+	}
+	for (size_t i = 0; i < count && res == 0; i++) {
+		res = light_write_packet(single, &packets[i].interface, &packets[i].header, packets[i].data);
+	}
+
+	const uint8_t* data[BATCH_SIZE];
+	light_packet_header batch_headers[BATCH_SIZE];
+	for (size_t start = 0; start < count && res == 0; ) {
+		size_t n = 0;
+		while (start + n < count && n < BATCH_SIZE && same_interface(&packets[start].interface, &packets[start + n].interface)) {
+			batch_headers[n] = packets[start + n].header;
+			data[n] = packets[start + n].data;
+			n++;
+		}
+		res = light_write_packets(batched, &packets[start].interface, batch_headers, data, n);
+		start += n;
+	}
+	light_pcapng_close(single);
+	light_pcapng_close(batched);
+
+	if (res != 0) {
+		fprintf(stderr, "Write failed: %d\n", res);
+	}
+	else {
+		size_t single_size, batched_size;
+		uint8_t* single_data = read_file(single_path, &single_size);
+		uint8_t* batched_data = read_file(batched_path, &batched_size);
+		if (single_data == NULL || batched_data == NULL || single_size != batched_size
+			|| memcmp(single_data, batched_data, single_size) != 0) {
+			fprintf(stderr, "%s and %s differ\n", single_path, batched_path);
+			res = 1;
+		}
+		free(single_data);
+		free(batched_data);
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		free(packets[i].header.comment);
+		free(packets[i].data);
+	}
+	free(packets);
+	light_pcapng_close(reader);
+	return res;
+}
@@ -0,0 +1,165 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Writes a gzip file of two members, then checks that seeking anywhere gives the same bytes as
+// reading from the start, both without the random access index and with one built for the file.
+
+#include "light_io.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 6MB per member, so several access points of 1MB in each
+#define MEMBER_SIZE (6 * 1024 * 1024)
+#define TOTAL_SIZE (2 * MEMBER_SIZE)
+#define READ_SIZE 70000
+#define SEEK_COUNT 40
+
+static void fill(uint8_t* data, size_t length)
+{
+	uint32_t state = 2166136261u;
+	for (size_t i = 0; i < length; i++) {
+		state = state * 1664525u + 1013904223u;
+		// Compressible, but not down to nothing
+		data[i] = (uint8_t)((state >> 24) & 0x1F);
+	}
+}
+
+static int write_member(const char* path, const uint8_t* data, size_t length)
+{
+	light_file file = light_io_open(path, "wb");
+	if (file == NULL || light_io_write(file, data, length) != length) {
+		fprintf(stderr, "Unable to write: %s\n", path);
+		return 1;
+	}
+	light_io_close(file);
+	return 0;
+}
+
+// Concatenated gzip members make one valid gzip file
+static int append_file(FILE* out, const char* path)
+{
+	FILE* in = fopen(path, "rb");
+	if (in == NULL) {
+		return 1;
+	}
+	char buffer[65536];
+	size_t n;
+	while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+		fwrite(buffer, 1, n, out);
+	}
+	fclose(in);
+	return 0;
+}
+
+static int check_seeks(const char* path, const uint8_t* expected)
+{
+	light_file file = light_io_open(path, "rb");
+	uint8_t* actual = malloc(READ_SIZE);
+	if (file == NULL || actual == NULL) {
+		fprintf(stderr, "Unable to open: %s\n", path);
+		return 1;
+	}
+	int res = 0;
+	uint32_t state = 12345;
+	for (int s = 0; s < SEEK_COUNT && res == 0; s++) {
+		state = state * 1664525u + 1013904223u;
+		int64_t offset = (int64_t)(state % (TOTAL_SIZE - READ_SIZE));
+		// Across the end of the first member too
+		if (s == 0) {
+			offset = MEMBER_SIZE - READ_SIZE / 2;
+		}
+		if (light_io_seek(file, offset, SEEK_SET) != offset || light_io_tell(file) != offset
+			|| light_io_read(file, actual, READ_SIZE) != READ_SIZE
+			|| memcmp(actual, expected + offset, READ_SIZE) != 0) {
+			fprintf(stderr, "Different bytes at %lld: %s\n", (long long)offset, path);
+			res = 1;
+		}
+	}
+	// Reading to the end after the last seek
+	if (res == 0) {
+		int64_t offset = light_io_tell(file);
+		size_t rest = (size_t)(TOTAL_SIZE - offset);
+		uint8_t* tail = malloc(rest + 1);
+		if (tail == NULL || light_io_read(file, tail, rest + 1) != rest || memcmp(tail, expected + offset, rest) != 0) {
+			fprintf(stderr, "Different bytes at the end: %s\n", path);
+			res = 1;
+		}
+		free(tail);
+	}
+	light_io_close(file);
+	free(actual);
+	return res;
+}
+
+int main(int argc, const char** args)
+{
+	if (argc != 2) {
+		fprintf(stderr, "Usage %s [outfile]", args[0]);
+		return 1;
+	}
+	const char* path = args[1];
+	size_t path_length = strlen(path);
+	char* member_path = malloc(path_length + 16);
+	char* index_path = malloc(path_length + 16);
+	uint8_t* expected = malloc(TOTAL_SIZE);
+	if (member_path == NULL || index_path == NULL || expected == NULL) {
+		return 1;
+	}
+	sprintf(member_path, "%s.member.gz", path);
+	sprintf(index_path, "%s.gzidx", path);
+	remove(index_path);
+	fill(expected, TOTAL_SIZE);
+
+	FILE* out = fopen(path, "wb");
+	if (out == NULL) {
+		fprintf(stderr, "Unable to write: %s\n", path);
+		return 1;
+	}
+	int res = 0;
+	for (int m = 0; m < 2 && res == 0; m++) {
+		res = write_member(member_path, expected + (size_t)m * MEMBER_SIZE, MEMBER_SIZE)
+			|| append_file(out, member_path);
+	}
+	fclose(out);
+	remove(member_path);
+
+	if (res == 0) {
+		res = check_seeks(path, expected);
+	}
+	if (res == 0 && light_io_build_index(path, 1) != 0) {
+		fprintf(stderr, "Unable to build the index: %s\n", path);
+		res = 1;
+	}
+	if (res == 0) {
+		res = check_seeks(path, expected);
+	}
+	// Only gzip files have an index
+	if (res == 0 && light_io_build_index(member_path, 1) == 0) {
+		fprintf(stderr, "Index built for a missing file\n");
+		res = 1;
+	}
+
+	free(member_path);
+	free(index_path);
+	free(expected);
+	return res;
+}
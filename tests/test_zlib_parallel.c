@@ -0,0 +1,57 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Writes a gzip capture on several workers, which makes one gzip member per block, and appends
+// to it the same way, then checks that reading it back gives every packet in order.
+
+#include "light_pcapng_ext.h"
+#include "light_pcapng.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "_util.h"
+
+// About 5MB, so several blocks of 1MB
+#define PACKET_COUNT 3500
+#define APPENDED_COUNT 500
+
+static const uint32_t packet_size = 1400;
+
+int main(int argc, const char** args)
+{
+	if (argc != 2) {
+		fprintf(stderr, "Usage %s [outfile]", args[0]);
+		return 1;
+	}
+	const char* path = args[1];
+
+	if (write_capture(path, "wb6,4", 0, PACKET_COUNT, &packet_size, 1) != 0
+		|| check_capture(path, "rb", PACKET_COUNT, &packet_size, 1) != 0) {
+		return 1;
+	}
+	// Appended members follow the ones already there
+	if (write_capture(path, "ab,2", PACKET_COUNT, APPENDED_COUNT, &packet_size, 1) != 0
+		|| check_capture(path, "rb", PACKET_COUNT + APPENDED_COUNT, &packet_size, 1) != 0) {
+		return 1;
+	}
+	return 0;
+}
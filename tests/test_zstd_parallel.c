@@ -0,0 +1,138 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Reads multi-frame zstd captures with decompression workers and checks that the bytes,
+// also after seeking, are the ones the sequential reader gives. Frames come from the seek
+// table of a seekable capture, and from the frame headers of concatenated frames.
+
+#include "light_pcapng_ext.h"
+#include "light_pcapng.h"
+#include "light_io.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zstd.h>
+
+#include "_util.h"
+
+#define PACKET_COUNT 3500
+#define READ_SIZE 3000
+
+static const uint32_t packet_size = 1400;
+
+// Compresses the sample in three separate frames, with a skippable frame in between
+static int write_frames(const char* sample, const char* path)
+{
+	FILE* in = fopen(sample, "rb");
+	FILE* out = fopen(path, "wb");
+	if (in == NULL || out == NULL) {
+		fprintf(stderr, "Unable to convert %s\n", sample);
+		return 1;
+	}
+	fseek(in, 0, SEEK_END);
+	size_t size = (size_t)ftell(in);
+	fseek(in, 0, SEEK_SET);
+	uint8_t* content = malloc(size);
+	size_t bound = ZSTD_compressBound(size);
+	uint8_t* compressed = malloc(bound);
+	if (fread(content, 1, size, in) != size) {
+		return 1;
+	}
+	size_t chunk = size / 3 + 1;
+	for (size_t start = 0; start < size; start += chunk) {
+		size_t length = start + chunk < size ? chunk : size - start;
+		size_t n = ZSTD_compress(compressed, bound, content + start, length, 3);
+		fwrite(compressed, 1, n, out);
+		if (start == 0) {
+			const uint8_t skippable[12] = { 0x50, 0x2A, 0x4D, 0x18, 4, 0, 0, 0, 1, 2, 3, 4 };
+			fwrite(skippable, 1, sizeof(skippable), out);
+		}
+	}
+	free(content);
+	free(compressed);
+	fclose(in);
+	fclose(out);
+	return 0;
+}
+
+static int compare(const char* path)
+{
+	light_file sequential = light_io_open(path, "rb");
+	light_file parallel = light_io_open(path, "rb,4");
+	if (sequential == NULL || parallel == NULL) {
+		fprintf(stderr, "Unable to open %s\n", path);
+		return 1;
+	}
+	static uint8_t expected[READ_SIZE], actual[READ_SIZE];
+	int res = 0;
+	size_t total = 0;
+	while (res == 0) {
+		size_t n = light_io_read(sequential, expected, READ_SIZE);
+		if (light_io_read(parallel, actual, READ_SIZE) != n || memcmp(expected, actual, n) != 0) {
+			fprintf(stderr, "Different bytes after %zu in %s\n", total, path);
+			res = 1;
+		}
+		total += n;
+		if (n < READ_SIZE) {
+			break;
+		}
+	}
+
+	// Backwards and forwards, across frames
+	const int64_t offsets[] = { 10, (int64_t)total / 2, 1 << 20, 3, (int64_t)total - 100, (int64_t)total / 3 };
+	for (size_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]) && res == 0; i++) {
+		if (light_io_seek(sequential, offsets[i], SEEK_SET) != light_io_seek(parallel, offsets[i], SEEK_SET)
+			|| light_io_tell(parallel) != light_io_tell(sequential)) {
+			fprintf(stderr, "Unable to seek to %lld in %s\n", (long long)offsets[i], path);
+			res = 1;
+			break;
+		}
+		size_t n = light_io_read(sequential, expected, READ_SIZE);
+		if (light_io_read(parallel, actual, READ_SIZE) != n || memcmp(expected, actual, n) != 0) {
+			fprintf(stderr, "Different bytes at %lld in %s\n", (long long)offsets[i], path);
+			res = 1;
+		}
+	}
+	light_io_close(sequential);
+	light_io_close(parallel);
+	return res;
+}
+
+int main(int argc, const char** args)
+{
+	if (argc != 4) {
+		fprintf(stderr, "Usage %s [sample] [seekable outfile] [frames outfile]", args[0]);
+		return 1;
+	}
+	// Frames of 1MB, so a handful of them
+	if (write_capture(args[2], "wb:1", 0, PACKET_COUNT, &packet_size, 1) != 0 || write_frames(args[1], args[3]) != 0) {
+		return 1;
+	}
+	if (compare(args[2]) != 0 || compare(args[3]) != 0) {
+		return 1;
+	}
+
+	// Packets come out whole and in order through the reader
+	if (check_capture(args[2], "rb,3", PACKET_COUNT, &packet_size, 1) != 0) {
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,173 @@
+// Copyright (c) 2026 Technica Engineering GmbH
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Writes captures in the zstd seekable format with small frames, then checks that seeking
+// anywhere reads the same bytes as reading from the start, and that appending keeps the seek table.
+
+#include "light_pcapng_ext.h"
+#include "light_pcapng.h"
+#include "light_io.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PACKET_SIZE 1400
+// About 5MB, so five frames of 1MB
+#define PACKET_COUNT 3500
+#define APPENDED_COUNT 100
+#define READ_SIZE 5000
+
+static int write_capture(const char* path, const char* mode, int first, int count)
+{
+	light_pcapng writer = light_pcapng_open(path, mode);
+	if (writer == NULL) {
+		fprintf(stderr, "Unable to write %s as %s\n", path, mode);
+		return 1;
+	}
+	light_packet_interface iface = { 0 };
+	iface.link_type = 1;
+	uint8_t data[PACKET_SIZE];
+	light_packet_header header = { 0 };
+	header.captured_length = sizeof(data);
+	header.original_length = sizeof(data);
+	for (int p = first; p < first + count; p++) {
+		for (int i = 0; i < PACKET_SIZE; i++) {
+			data[i] = (uint8_t)((p * 31 + i * 7) ^ (i >> 3));
+		}
+		header.timestamp.tv_sec = p;
+		if (light_write_packet(writer, &iface, &header, data) != LIGHT_SUCCESS) {
+			fprintf(stderr, "Packet #%d not written\n", p + 1);
+			light_pcapng_close(writer);
+			return 1;
+		}
+	}
+	light_pcapng_close(writer);
+	return 0;
+}
+
+static int count_packets(const char* path)
+{
+	light_pcapng reader = light_pcapng_open(path, "rb");
+	if (reader == NULL) {
+		return -1;
+	}
+	int count = 0;
+	light_packet_interface iface;
+	light_packet_header header;
+	const uint8_t* data = NULL;
+	while (light_read_packet(reader, &iface, &header, &data) == LIGHT_SUCCESS && data != NULL) {
+		if (header.timestamp.tv_sec != count) {
+			fprintf(stderr, "Packet #%d out of place\n", count + 1);
+			count = -1;
+			break;
+		}
+		free(header.comment);
+		count++;
+	}
+	light_pcapng_close(reader);
+	return count;
+}
+
+// Decompressed size, -1 on error
+static int64_t read_all(const char* path, uint8_t** content)
+{
+	light_file file = light_io_open(path, "rb");
+	if (file == NULL) {
+		return -1;
+	}
+	size_t size = 0, capacity = 1 << 20;
+	*content = malloc(capacity);
+	size_t n;
+	while (*content != NULL && (n = light_io_read(file, *content + size, capacity - size)) > 0) {
+		size += n;
+		if (size == capacity) {
+			capacity *= 2;
+			*content = realloc(*content, capacity);
+		}
+	}
+	light_io_close(file);
+	return *content ? (int64_t)size : -1;
+}
+
+static int check_seeks(const char* path, bool seek_table)
+{
+	uint8_t* content = NULL;
+	int64_t size = read_all(path, &content);
+	if (size < READ_SIZE) {
+		fprintf(stderr, "Unable to read %s\n", path);
+		return 1;
+	}
+
+	light_file file = light_io_open(path, "rb");
+	uint8_t buffer[READ_SIZE];
+	int res = 0;
+	// Forwards and backwards, within frames and across frame boundaries
+	const int64_t offsets[] = { 0, size / 2, 1 << 20, (1 << 20) - 10, size - READ_SIZE, 7, 3 * (1 << 20) + 123, 2 * (1 << 20) };
+	for (size_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]) && res == 0; i++) {
+		int64_t offset = offsets[i];
+		if (offset + READ_SIZE > size) {
+			continue;
+		}
+		if (light_io_seek(file, offset, SEEK_SET) != offset || light_io_tell(file) != offset
+			|| light_io_read(file, buffer, READ_SIZE) != READ_SIZE || memcmp(buffer, content + offset, READ_SIZE) != 0) {
+			fprintf(stderr, "Different bytes at %lld in %s\n", (long long)offset, path);
+			res = 1;
+		}
+	}
+	// Only the seek table tells where the end is
+	int64_t end = light_io_seek(file, 0, SEEK_END);
+	if (res == 0 && (seek_table ? end != size : end != -1)) {
+		fprintf(stderr, "Seeking to the end of %s gives %lld\n", path, (long long)end);
+		res = 1;
+	}
+
+	light_io_close(file);
+	free(content);
+	return res;
+}
+
+int main(int argc, const char** args)
+{
+	if (argc != 3) {
+		fprintf(stderr, "Usage %s [seekable outfile] [single frame outfile]", args[0]);
+		return 1;
+	}
+	const char* seekable = args[1];
+	const char* single = args[2];
+
+	if (write_capture(seekable, "wb:1", 0, PACKET_COUNT) != 0 || write_capture(single, "wb:0", 0, PACKET_COUNT) != 0) {
+		return 1;
+	}
+	if (check_seeks(seekable, true) != 0 || check_seeks(single, false) != 0) {
+		return 1;
+	}
+
+	// Appended frames go on in the seek table
+	if (write_capture(seekable, "a+", PACKET_COUNT, APPENDED_COUNT) != 0) {
+		return 1;
+	}
+	int count = count_packets(seekable);
+	if (count != PACKET_COUNT + APPENDED_COUNT) {
+		fprintf(stderr, "%d packets read back after appending\n", count);
+		return 1;
+	}
+	return check_seeks(seekable, true);
+}